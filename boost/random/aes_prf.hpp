@@ -0,0 +1,335 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_AES_PRF_HPP
+#define BOOST_RANDOM_AES_PRF_HPP
+
+#include <boost/config.hpp>
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/random/detail/aes_round.hpp>
+#include <boost/random/detail/simd.hpp>
+#include <boost/random/detail/simd_dispatch.hpp>
+#include <boost/random/detail/unroll.hpp>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+
+// aes_prf - AES-128 (FIPS-197) encryption, as a pseudo-random
+//   function of the counter, i.e., counter-mode AES.
+//
+//     counter_based_engine<uint64_t, aes_prf>
+//
+//   Unlike ars_prf, it's the standard cipher, with the standard key
+//   expansion, so its output can be checked against any other AES
+//   implementation.  The domain, range and key are 128-bit blocks, as
+//   a boost::array<uint64_t, 2>, with bytes 0..7 of the block (in the
+//   order FIPS-197 writes them) in word 0, little-endian, and bytes
+//   8..15 in word 1.  On x86, that's what _mm_loadu_si128 of the
+//   bytes gives you.
+//
+//   The key is expanded into the eleven round keys by the constructor
+//   and setkey(), so an aes_prf is 176 bytes, and keying one costs
+//   about as much as ten calls.  It's fine to re-key at thread-scope,
+//   but not in an inner loop.
+//
+//   Speed:  like ars_prf, it uses the AES-NI instructions if the CPU
+//   has them, and portable, table-free rounds (hundreds of times
+//   slower) if it doesn't.  One block at a time, AES-NI is limited by
+//   the latency of aesenc, but independent blocks can share the
+//   pipeline, so the batch operator() (and counter_based_engine::fill)
+//   does 8 blocks at a time with aesenc, or 16 at a time with the
+//   512-bit VAES instructions.  That's 3-5x faster.  The choices are
+//   made once, the first time they're needed (the batch kernel's by
+//   detail::select_kernel, with a self-test - see
+//   detail/simd_dispatch.hpp), and the results are the same either
+//   way.
+class aes_prf {
+    // The batch kernels treat arrays of blocks as arrays of __m128i.
+    BOOST_STATIC_ASSERT(sizeof(detail::aes_block) == 16);
+public:
+    typedef boost::array<uint64_t, 2> domain_type;
+    typedef boost::array<uint64_t, 2> range_type;
+    typedef boost::array<uint64_t, 2> key_type;
+    typedef boost::array<detail::aes_block, 11> schedule_type;
+
+    aes_prf(){ setkey(key_type()); }
+    aes_prf(key_type _k){ setkey(_k); }
+
+    void setkey(key_type _k){
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+        static const bool aesni = detail::aes_has_aesni();
+        if( aesni )
+            return aesni_expand(_k, rk);
+#endif
+        portable_expand(_k, rk);
+    }
+
+    key_type getkey() const{
+        return rk[0];
+    }
+
+    bool operator==(const aes_prf& rhs) const{
+        return rk[0] == rhs.rk[0];
+    }
+
+    bool operator!=(const aes_prf& rhs) const{
+        return rk[0] != rhs.rk[0];
+    }
+
+    range_type operator()(domain_type c) const{
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+        static const bool aesni = detail::aes_has_aesni();
+        if( aesni )
+            return aesni_apply(rk, c);
+#endif
+        return portable_apply(rk, c);
+    }
+
+    // The batch operator() (see detail/prf_batch.hpp).
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        std::size_t i = 0;
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+        static const batch_kernel_type kernel = detail::select_kernel<_batch_kernels>(_batch_kernel_test());
+        if( kernel )
+            i = kernel(rk, in, out, n);
+#endif
+        for( ; i<n; ++i)
+            out[i] = (*this)(in[i]);
+    }
+
+    // portable_expand and aesni_expand - the AES-128 key expansion,
+    // FIPS-197 section 5.2.  The words of the key schedule are
+    // little-endian, so RotWord is a rotate right and Rcon goes in
+    // the low byte.  Only call aesni_expand if detail::aes_has_aesni().
+    static void portable_expand(const key_type& k, schedule_type& s){
+        s[0] = k;
+        uint32_t rcon = 1;
+        for(unsigned r=1; r<11; ++r){
+            uint32_t w3 = uint32_t(s[r-1][1] >> 32);
+            uint32_t t = uint32_t(detail::aes_subbytes((w3 >> 8) | (w3 << 24))) ^ rcon;
+            uint32_t w0 = uint32_t(s[r-1][0]) ^ t;
+            uint32_t w1 = uint32_t(s[r-1][0] >> 32) ^ w0;
+            uint32_t w2 = uint32_t(s[r-1][1]) ^ w1;
+            w3 ^= w2;
+            s[r][0] = w0 | (uint64_t(w1) << 32);
+            s[r][1] = w2 | (uint64_t(w3) << 32);
+            rcon = uint32_t(detail::gf8_xtime(rcon));
+        }
+    }
+
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+    BOOST_RANDOM_DETAIL_AESNI_TARGET
+    static void aesni_expand(const key_type& k, schedule_type& s){
+        __m128i v = detail::aes_load(k);
+        s[0] = k;
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x01), s[1]);
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x02), s[2]);
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x04), s[3]);
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x08), s[4]);
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x10), s[5]);
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x20), s[6]);
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x40), s[7]);
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x80), s[8]);
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x1b), s[9]);
+        v = aesni_expand_step(v, _mm_aeskeygenassist_si128(v, 0x36), s[10]);
+    }
+#endif
+
+    // portable_apply and the aesni_apply and vaes_apply kernels - the
+    // implementations of the operator()s, exposed for testing.  The
+    // batch kernels do the largest multiple of 8 (aesni_apply) or 16
+    // (vaes_apply) counters that's <= n, and return how many they
+    // did.  Only call aesni_apply if detail::aes_has_aesni(), and
+    // vaes_apply if detail::aes_has_vaes().
+    static range_type portable_apply(const schedule_type& s, domain_type v){
+        v[0] ^= s[0][0];
+        v[1] ^= s[0][1];
+        _portable_rounds rs(v, s);
+        detail::unroll<10, 1>::apply(rs);
+        return detail::aes_round_last(v, s[10]);
+    }
+
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+    BOOST_RANDOM_DETAIL_AESNI_TARGET
+    static range_type aesni_apply(const schedule_type& s, domain_type c){
+        __m128i v = _mm_xor_si128(detail::aes_load(c), key128(s, 0));
+        for(unsigned r=1; r<10; ++r)
+            v = _mm_aesenc_si128(v, key128(s, r));
+        return detail::aes_store(_mm_aesenclast_si128(v, key128(s, 10)));
+    }
+
+    // The lanes are written out, rather than kept in an array,
+    // because compilers don't reliably keep an array of vectors in
+    // registers.
+    BOOST_RANDOM_DETAIL_AESNI_TARGET
+    static std::size_t aesni_apply(const schedule_type& s, const domain_type* in, range_type* out, std::size_t n){
+        std::size_t m = n - n%8;
+        for(std::size_t i=0; i<m; i+=8){
+            const __m128i* p = reinterpret_cast<const __m128i*>(in[i].data());
+            __m128i* q = reinterpret_cast<__m128i*>(out[i].data());
+            __m128i k = key128(s, 0);
+            __m128i v0 = _mm_xor_si128(_mm_loadu_si128(p+0), k);
+            __m128i v1 = _mm_xor_si128(_mm_loadu_si128(p+1), k);
+            __m128i v2 = _mm_xor_si128(_mm_loadu_si128(p+2), k);
+            __m128i v3 = _mm_xor_si128(_mm_loadu_si128(p+3), k);
+            __m128i v4 = _mm_xor_si128(_mm_loadu_si128(p+4), k);
+            __m128i v5 = _mm_xor_si128(_mm_loadu_si128(p+5), k);
+            __m128i v6 = _mm_xor_si128(_mm_loadu_si128(p+6), k);
+            __m128i v7 = _mm_xor_si128(_mm_loadu_si128(p+7), k);
+            for(unsigned r=1; r<10; ++r){
+                k = key128(s, r);
+                v0 = _mm_aesenc_si128(v0, k);
+                v1 = _mm_aesenc_si128(v1, k);
+                v2 = _mm_aesenc_si128(v2, k);
+                v3 = _mm_aesenc_si128(v3, k);
+                v4 = _mm_aesenc_si128(v4, k);
+                v5 = _mm_aesenc_si128(v5, k);
+                v6 = _mm_aesenc_si128(v6, k);
+                v7 = _mm_aesenc_si128(v7, k);
+            }
+            k = key128(s, 10);
+            _mm_storeu_si128(q+0, _mm_aesenclast_si128(v0, k));
+            _mm_storeu_si128(q+1, _mm_aesenclast_si128(v1, k));
+            _mm_storeu_si128(q+2, _mm_aesenclast_si128(v2, k));
+            _mm_storeu_si128(q+3, _mm_aesenclast_si128(v3, k));
+            _mm_storeu_si128(q+4, _mm_aesenclast_si128(v4, k));
+            _mm_storeu_si128(q+5, _mm_aesenclast_si128(v5, k));
+            _mm_storeu_si128(q+6, _mm_aesenclast_si128(v6, k));
+            _mm_storeu_si128(q+7, _mm_aesenclast_si128(v7, k));
+        }
+        return m;
+    }
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_VAES)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+    // Four zmm registers of four blocks each.
+    BOOST_RANDOM_DETAIL_VAES_TARGET
+    static std::size_t vaes_apply(const schedule_type& s, const domain_type* in, range_type* out, std::size_t n){
+        std::size_t m = n - n%16;
+        for(std::size_t i=0; i<m; i+=16){
+            const __m512i* p = reinterpret_cast<const __m512i*>(in[i].data());
+            __m512i* q = reinterpret_cast<__m512i*>(out[i].data());
+            __m512i k = key512(s, 0);
+            __m512i v0 = _mm512_xor_si512(_mm512_loadu_si512(p+0), k);
+            __m512i v1 = _mm512_xor_si512(_mm512_loadu_si512(p+1), k);
+            __m512i v2 = _mm512_xor_si512(_mm512_loadu_si512(p+2), k);
+            __m512i v3 = _mm512_xor_si512(_mm512_loadu_si512(p+3), k);
+            for(unsigned r=1; r<10; ++r){
+                k = key512(s, r);
+                v0 = _mm512_aesenc_epi128(v0, k);
+                v1 = _mm512_aesenc_epi128(v1, k);
+                v2 = _mm512_aesenc_epi128(v2, k);
+                v3 = _mm512_aesenc_epi128(v3, k);
+            }
+            k = key512(s, 10);
+            _mm512_storeu_si512(q+0, _mm512_aesenclast_epi128(v0, k));
+            _mm512_storeu_si512(q+1, _mm512_aesenclast_epi128(v1, k));
+            _mm512_storeu_si512(q+2, _mm512_aesenclast_epi128(v2, k));
+            _mm512_storeu_si512(q+3, _mm512_aesenclast_epi128(v3, k));
+        }
+        return m;
+    }
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif
+
+protected:
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+    typedef std::size_t (*batch_kernel_type)(const schedule_type&, const domain_type*, range_type*, std::size_t);
+
+    // The batch kernels for detail::select_kernel:  VAES, then
+    // aesni_apply for what's left, at simd_avx512, and aesni_apply
+    // alone at the levels below.  Either one only if the CPU has the
+    // instructions, which aren't part of the levels.
+    struct _batch_kernels{
+        typedef batch_kernel_type kernel_type;
+        static kernel_type kernel(detail::simd_level l){
+#if defined(BOOST_RANDOM_HAVE_VAES)
+            if( l == detail::simd_avx512 && detail::aes_has_vaes() )
+                return &vaes_aesni_apply;
+#endif
+            if( l < detail::simd_avx512 && detail::aes_has_aesni() )
+                return static_cast<batch_kernel_type>(&aesni_apply);
+            return 0;
+        }
+    };
+
+    // The self-test compares the kernel with the single-block
+    // operator() under a key and counters from the usual sequence.
+    struct _batch_kernel_test{
+        bool operator()(batch_kernel_type kernel) const{
+            uint64_t x = 0;
+            key_type k;
+            detail::selftest_words(k, x);
+            domain_type in[detail::selftest_size];
+            range_type out[detail::selftest_size];
+            for(std::size_t i=0; i<detail::selftest_size; ++i)
+                detail::selftest_words(in[i], x);
+            const aes_prf prf(k);
+            std::size_t m = kernel(prf.rk, in, out, detail::selftest_size);
+            if( m > detail::selftest_size )
+                return false;
+            for(std::size_t i=0; i<m; ++i)
+                if( out[i] != prf(in[i]) )
+                    return false;
+            return true;
+        }
+    };
+
+#if defined(BOOST_RANDOM_HAVE_VAES)
+    static std::size_t vaes_aesni_apply(const schedule_type& s, const domain_type* in, range_type* out, std::size_t n){
+        std::size_t i = vaes_apply(s, in, out, n);
+        return i + aesni_apply(s, in+i, out+i, n-i);
+    }
+#endif
+
+    // One step of the key expansion:  t's high word is
+    // SubWord(RotWord(w3)) ^ Rcon, from aeskeygenassist.
+    BOOST_RANDOM_DETAIL_AESNI_TARGET
+    static __m128i aesni_expand_step(__m128i k, __m128i t, detail::aes_block& rkey){
+        t = _mm_shuffle_epi32(t, 0xff);
+        k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+        k = _mm_xor_si128(k, t);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rkey.data()), k);
+        return k;
+    }
+
+    BOOST_RANDOM_DETAIL_AESNI_TARGET
+    static __m128i key128(const schedule_type& s, unsigned r){
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(s[r].data()));
+    }
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_VAES)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+    BOOST_RANDOM_DETAIL_VAES_TARGET
+    static __m512i key512(const schedule_type& s, unsigned r){
+        return _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s[r].data())));
+    }
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif
+
+    struct _portable_rounds{
+        domain_type& v;
+        const schedule_type& s;
+        _portable_rounds(domain_type& _v, const schedule_type& _s) : v(_v), s(_s){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            v = detail::aes_round(v, s[r]);
+        }
+    };
+
+    schedule_type rk;
+};
+
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_AES_PRF_HPP
@@ -0,0 +1,130 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_ARS_HPP
+#define BOOST_RANDOM_ARS_HPP
+
+#include <boost/config.hpp>
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/random/detail/aes_round.hpp>
+#include <boost/random/detail/unroll.hpp>
+
+namespace boost{
+namespace random{
+
+// ars_prf<R> - the ARS (Advanced Randomization System) pseudo-random
+//   function from Salmon et al., "Parallel Random Numbers:  As Easy
+//   as 1, 2, 3".  It's R-1 AES rounds and a final AES round, with
+//   round keys that are a Weyl sequence starting from the user's key
+//   (the golden ratio and sqrt(3)-1 in the low and high 64-bit
+//   words), and no AES key schedule.  Five rounds are Crush-resistant
+//   with no safety margin.  Seven, the default, are recommended.
+//
+//     counter_based_engine<uint64_t, ars_prf<> >
+//
+//   The domain, range and key are 128 bits, as a
+//   boost::array<uint64_t, 2>, with the low 64 bits of the AES state
+//   in word 0 (see detail/aes_round.hpp).  So it's the same function
+//   as one written with __m128i and _mm_aesenc_si128, word for word,
+//   but it doesn't need x86 or an __m128i counter_traits.
+//
+//   Speed:  with AES-NI, it's the fastest Crush-resistant Prf we know
+//   of, about 1 cycle per byte.  ars_prf uses the AES-NI instructions
+//   if the CPU has them, whatever the compiler was told about the
+//   target, and portable, table-free AES rounds if it doesn't.  The
+//   choice is made once, the first time an ars_prf is called.
+//   The portable rounds give bit-identical results, but they're
+//   hundreds of times slower, so on CPUs without AES-NI, threefry or
+//   philox are much better choices.
+template <unsigned R=7>
+class ars_prf {
+    BOOST_STATIC_ASSERT(R >= 1 && R <= 10);
+public:
+    typedef boost::array<uint64_t, 2> domain_type;
+    typedef boost::array<uint64_t, 2> range_type;
+    typedef boost::array<uint64_t, 2> key_type;
+
+    ars_prf() : k(){}
+    ars_prf(key_type _k) : k(_k){}
+
+    void setkey(key_type _k){
+        k = _k;
+    }
+
+    key_type getkey() const{
+        return k;
+    }
+
+    bool operator==(const ars_prf& rhs) const{
+        return k == rhs.k;
+    }
+
+    bool operator!=(const ars_prf& rhs) const{
+        return k != rhs.k;
+    }
+
+    range_type operator()(domain_type c) const{
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+        static const bool aesni = detail::aes_has_aesni();
+        if( aesni )
+            return aesni_apply(k, c);
+#endif
+        return portable_apply(k, c);
+    }
+
+    // portable_apply and aesni_apply - the two implementations of
+    // operator(), exposed for testing.  Only call aesni_apply if
+    // detail::aes_has_aesni().
+    static range_type portable_apply(key_type kk, domain_type v){
+        _portable_rounds rs(v, kk);
+        detail::unroll<R-1>::apply(rs);
+        weyl(kk);
+        return detail::aes_round_last(v, kk);
+    }
+
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+    BOOST_RANDOM_DETAIL_AESNI_TARGET
+    static range_type aesni_apply(const key_type& key, domain_type c){
+        const __m128i kweyl = _mm_set_epi64x(kweyl1, kweyl0);
+        __m128i kk = detail::aes_load(key);
+        __m128i v = detail::aes_load(c);
+        for(unsigned r=1; r<R; ++r){
+            kk = _mm_add_epi64(kk, kweyl);
+            v = _mm_aesenc_si128(v, kk);
+        }
+        kk = _mm_add_epi64(kk, kweyl);
+        return detail::aes_store(_mm_aesenclast_si128(v, kk));
+    }
+#endif
+
+protected:
+    BOOST_STATIC_CONSTANT(uint64_t, kweyl0 = UINT64_C(0x9E3779B97F4A7C15)); // golden ratio
+    BOOST_STATIC_CONSTANT(uint64_t, kweyl1 = UINT64_C(0xBB67AE8584CAA73B)); // sqrt(3) - 1.0
+
+    static void weyl(key_type& kk){
+        kk[0] += kweyl0;
+        kk[1] += kweyl1;
+    }
+
+    struct _portable_rounds{
+        domain_type& v;
+        key_type& kk;
+        _portable_rounds(domain_type& _v, key_type& _kk) : v(_v), kk(_kk){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            weyl(kk);
+            v = detail::aes_round(v, kk);
+        }
+    };
+
+    key_type k;
+};
+
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_ARS_HPP
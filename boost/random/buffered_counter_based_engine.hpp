@@ -0,0 +1,360 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_BUFFERED_COUNTER_BASED_ENGINE_HPP
+#define BOOST_RANDOM_BUFFERED_COUNTER_BASED_ENGINE_HPP
+
+#include <boost/random/counter_based_engine.hpp>
+#include <boost/random/detail/prf_batch.hpp>
+#include <boost/integer/static_min_max.hpp>
+
+namespace boost{
+namespace random{
+
+// buffered_counter_based_engine - a counter_based_engine that
+//  computes BufferBlocks consecutive blocks of the Prf's range at a
+//  time (through the Prf's batch operator(), if it has one - see
+//  detail/prf_batch.hpp) and serves operator()() from a flat array of
+//  results.
+//
+//  It produces exactly the same sequence as the corresponding
+//  counter_based_engine, and discard(), restart(), seed(), equality
+//  and the stream operators all behave the same way.  In particular,
+//  an engine written to a stream by one can be read by the other.
+//
+//  The counter_based_engine calls the Prf every
+//  results_per_counter() outputs, which is as often as every other
+//  call for, e.g., philox<2, uint32_t> with 32-bit results.  The
+//  buffered engine trades a bigger object (BufferBlocks range_types
+//  worth of results) for fewer, cheaper Prf invocations and a tighter
+//  operator()().  It's meant for code that draws one value at a time,
+//  e.g., in a loop over a distribution.  Code that can use fill()
+//  gets the same benefit from the unbuffered engine.
+//
+//  N.B.  BufferBlocks is the third template parameter, so the
+//  CtrBits and w parameters are fourth and fifth, one place later
+//  than in counter_based_engine.
+template<typename UintType,
+         typename Prf,
+         unsigned BufferBlocks = 16,
+         unsigned CtrBits = static_unsigned_min<64u, detail::counter_traits<typename Prf::domain_type>::Nbits/2>::value,
+         unsigned w = std::numeric_limits<UintType>::digits,
+         typename DomainTraits = detail::counter_traits<typename Prf::domain_type>,
+         typename RangeTraits = detail::counter_traits<typename Prf::range_type>,
+         typename KeyTraits = detail::counter_traits<typename Prf::key_type>
+>
+struct buffered_counter_based_engine
+    : private counter_based_engine<UintType, Prf, CtrBits, w, DomainTraits, RangeTraits, KeyTraits> {
+    typedef counter_based_engine<UintType, Prf, CtrBits, w, DomainTraits, RangeTraits, KeyTraits> base_type;
+    typedef UintType result_type;
+    BOOST_STATIC_CONSTANT(unsigned, word_size = w);
+    BOOST_STATIC_CONSTANT(bool, has_fixed_range = false);
+
+    typedef Prf prf_type;
+    BOOST_STATIC_CONSTANT(unsigned, counter_bits = CtrBits);
+    BOOST_STATIC_CONSTANT(unsigned, buffer_blocks = BufferBlocks);
+    typedef typename Prf::domain_type domain_type;
+    typedef typename Prf::range_type range_type;
+    typedef typename Prf::key_type key_type;
+    typedef DomainTraits domain_traits;
+    typedef RangeTraits range_traits;
+    typedef KeyTraits key_traits;
+
+protected:
+    BOOST_STATIC_ASSERT(BufferBlocks > 0);
+    // results_per_counter() isn't a compile-time constant, but
+    // RangeTraits::Nbits/w is an upper bound for it.
+    BOOST_STATIC_CONSTANT(unsigned, MaxNresult = (static_unsigned_max<1u, RangeTraits::Nbits/w>::value));
+
+    // While the buffer is in use (end != 0), buf[0, end) holds the
+    // results from the blocks with counters base_type::c, c+1, ...,
+    // lastctr.  The next result to be returned is buf[pos].  The base
+    // class's next and v are stale.  When the buffer is not in use
+    // (end == 0), the base class's c, next and v are the state of the
+    // engine.
+    //
+    // The state (pos, c) corresponds to a state (next, ctr) of
+    // the unbuffered engine: (0, c) if pos is zero, and otherwise
+    // ((pos-1)%Nresult+1, c+(pos-1)/Nresult).  pos is only zero right
+    // after a seed or restart.
+    result_type buf[BufferBlocks*MaxNresult];
+    unsigned pos;
+    unsigned end;
+    domain_type lastctr;
+
+    void invalidate(){
+        pos = end = 0;
+    }
+
+    void unbuffered_state(domain_type& ctr, unsigned& nxt) const{
+        if( end == 0 ){
+            ctr = this->c;
+            nxt = this->next;
+        }else if( pos == 0 ){
+            ctr = this->c;
+            nxt = 0;
+        }else{
+            const unsigned Nresult = results_per_counter();
+            unsigned blk = (pos-1)/Nresult;
+            ctr = DomainTraits::template incr<CtrBits>(this->c, blk);
+            nxt = pos - blk*Nresult;
+        }
+    }
+
+    // sync - put the engine's state back into the base class, so we
+    // can use the base class's discard and fill on it.  Only c and
+    // next are set.  v is left stale rather than spending a Prf call
+    // on it, because neither caller reads it:  the base's discard
+    // always recomputes v, and fill only syncs once the buffer is used
+    // up, when next == results_per_counter(), so it starts a new block.
+    void sync(){
+        if( end ){
+            domain_type ctr;
+            unsigned nxt;
+            unbuffered_state(ctr, nxt);
+            this->c = ctr;
+            this->next = nxt;
+            invalidate();
+        }
+    }
+
+    // refill - called when pos == end.  Compute up to BufferBlocks
+    // blocks, starting with the one that holds the next result.  We
+    // stop short if we run out of counters, so that the exception is
+    // thrown only when the caller actually asks for the value past
+    // the end of the sequence - just like the unbuffered engine.
+    void refill(){
+        const unsigned Nresult = results_per_counter();
+        domain_type start;
+        unsigned newpos = 0;
+        if( end == 0 && this->next < Nresult ){
+            start = this->c;
+            newpos = this->next;
+        }else{
+            start = DomainTraits::template incr<CtrBits>(end ? lastctr : this->c);
+        }
+        domain_type in[BufferBlocks];
+        range_type out[BufferBlocks];
+        in[0] = start;
+        unsigned m = 1;
+        for( ; m<BufferBlocks; ++m){
+            in[m] = in[m-1];
+            if( !DomainTraits::template try_incr<CtrBits>(in[m]) )
+                break;
+        }
+        detail::prf_batch(this->b, in, out, m);
+        result_type* p = buf;
+        for(unsigned j=0; j<m; ++j)
+            for(unsigned i=0; i<Nresult; ++i)
+                *p++ = RangeTraits::template at<result_type, w>(i, out[j]);
+        this->c = start;
+        lastctr = in[m-1];
+        pos = newpos;
+        end = m*Nresult;
+    }
+
+public:
+    BOOST_RANDOM_DETAIL_CONSTEXPR static result_type min BOOST_PREVENT_MACRO_SUBSTITUTION () { return 0; }
+    BOOST_RANDOM_DETAIL_CONSTEXPR static result_type max BOOST_PREVENT_MACRO_SUBSTITUTION () { return low_bits_mask_t<w>::sig_bits; }
+
+    // The constructors and seed methods are exactly those of
+    // counter_based_engine.  See counter_based_engine.hpp.
+    buffered_counter_based_engine() : base_type(), pos(), end() {}
+
+    buffered_counter_based_engine(buffered_counter_based_engine& e)
+        : base_type(static_cast<const base_type&>(e)), pos(), end()
+    { copy_buffer(e); }
+
+    buffered_counter_based_engine(const buffered_counter_based_engine& e)
+        : base_type(static_cast<const base_type&>(e)), pos(), end()
+    { copy_buffer(e); }
+
+    buffered_counter_based_engine& operator=(const buffered_counter_based_engine& rhs){
+        if( this == &rhs )
+            return *this;
+        base_type::operator=(rhs);
+        invalidate();
+        copy_buffer(rhs);
+        return *this;
+    }
+
+    BOOST_RANDOM_DETAIL_ARITHMETIC_CONSTRUCTOR(buffered_counter_based_engine, boost::uintmax_t, value)
+        : base_type(value), pos(), end()
+    {}
+
+    BOOST_RANDOM_DETAIL_SEED_SEQ_CONSTRUCTOR(buffered_counter_based_engine, SeedSeq, seq)
+        : base_type(seq), pos(), end()
+    {}
+
+    template<class It> buffered_counter_based_engine(It& first, It last)
+        : base_type(first, last), pos(), end()
+    {}
+
+    template<class It> buffered_counter_based_engine(const It& first, It last)
+        : base_type(first, last), pos(), end()
+    {}
+
+    explicit buffered_counter_based_engine(key_type k, domain_type base = DomainTraits::make_counter())
+        : base_type(k, base), pos(), end()
+    {}
+
+    explicit buffered_counter_based_engine(const Prf& _b, domain_type base = DomainTraits::make_counter())
+        : base_type(_b, base), pos(), end()
+    {}
+
+    void seed(){
+        base_type::seed();
+        invalidate();
+    }
+
+    BOOST_RANDOM_DETAIL_ARITHMETIC_SEED(buffered_counter_based_engine, boost::uintmax_t, value){
+        base_type::seed(value);
+        invalidate();
+    }
+
+    BOOST_RANDOM_DETAIL_SEED_SEQ_SEED(buffered_counter_based_engine, SeedSeq, seq){
+        base_type::seed(seq);
+        invalidate();
+    }
+
+    template<class It>
+    void seed(It& first, It last){
+        base_type::seed(first, last);
+        invalidate();
+    }
+
+    template<class It>
+    void seed(const It& first, It last){
+        base_type::seed(first, last);
+        invalidate();
+    }
+
+    void seed(key_type k, domain_type base){
+        base_type::seed(k, base);
+        invalidate();
+    }
+
+    void seed(const Prf& _b, domain_type base){
+        base_type::seed(_b, base);
+        invalidate();
+    }
+
+    void restart(domain_type base){
+        base_type::restart(base);
+        invalidate();
+    }
+
+#if !defined(BOOST_NO_CXX11_HDR_INITIALIZER_LIST)
+    template <typename V>
+    void restart(std::initializer_list<V> il){
+        restart( DomainTraits::make_counter(il) );
+    }
+#endif
+
+    void restart_unchecked(domain_type base){
+        base_type::restart_unchecked(base);
+        invalidate();
+    }
+
+    // restart_and_draw goes straight to the base class, bypassing the
+    // buffer, which would only be thrown away at the next restart.
+    template <unsigned N, class OutIt>
+    OutIt restart_and_draw(domain_type base, OutIt out){
+        invalidate();
+        return base_type::template restart_and_draw<N>(base, out);
+    }
+
+    BOOST_RANDOM_DETAIL_EQUALITY_OPERATOR(buffered_counter_based_engine, lhs, rhs){
+        domain_type lc, rc;
+        unsigned ln, rn;
+        lhs.unbuffered_state(lc, ln);
+        rhs.unbuffered_state(rc, rn);
+        return DomainTraits::is_equal(lc, rc) &&
+            ln == rn &&
+            lhs.b == rhs.b;
+    }
+
+    BOOST_RANDOM_DETAIL_INEQUALITY_OPERATOR(buffered_counter_based_engine)
+
+    BOOST_RANDOM_DETAIL_OSTREAM_OPERATOR(os, buffered_counter_based_engine, f){
+        domain_type ctr;
+        unsigned nxt;
+        f.unbuffered_state(ctr, nxt);
+        os << nxt << ' ';
+        DomainTraits::insert(os, ctr) << ' ';
+        KeyTraits::insert(os, f.b.getkey());
+        return os;
+    }
+
+    BOOST_RANDOM_DETAIL_ISTREAM_OPERATOR(is, buffered_counter_based_engine, f){
+        is >> static_cast<base_type&>(f);
+        if( is )
+            f.invalidate();
+        return is;
+    }
+
+    result_type operator()(){
+        if( pos == end )
+            refill();
+        return buf[pos++];
+    }
+
+    void discard(boost::uintmax_t skip){
+        if( end && skip <= end - pos ){
+            pos += static_cast<unsigned>(skip);
+            return;
+        }
+        sync();
+        base_type::discard(skip);
+    }
+
+    template <class Iter>
+    void generate(Iter first, Iter last)
+    { detail::generate_from_int(*this, first, last); }
+
+    void generate(result_type* first, result_type* last){
+        if( w == 32 )
+            fill(first, last);
+        else
+            detail::generate_from_int(*this, first, last);
+    }
+
+    // fill - as in counter_based_engine.  Whatever is left in the
+    //  buffer is used first, and the rest is done by
+    //  counter_based_engine::fill.
+    template <class OutIt>
+    void fill(OutIt first, OutIt last){
+        boost::uintmax_t n = std::distance(first, last);
+        for( ; n && pos < end; --n)
+            *first++ = buf[pos++];
+        if( n ){
+            OutIt mid = first;
+            std::advance(mid, n);
+            sync();
+            base_type::fill(first, mid);
+        }
+    }
+
+    // at and operator[] don't depend on the engine's position, so
+    // the buffer doesn't matter.
+    using base_type::at;
+    using base_type::operator[];
+    using base_type::results_per_counter;
+
+protected:
+    void copy_buffer(const buffered_counter_based_engine& e){
+        if( e.end ){
+            std::copy(e.buf, e.buf+e.end, buf);
+            pos = e.pos;
+            end = e.end;
+            lastctr = e.lastctr;
+        }
+    }
+};
+
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_BUFFERED_COUNTER_BASED_ENGINE_HPP
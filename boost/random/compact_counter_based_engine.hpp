@@ -0,0 +1,246 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_COMPACT_COUNTER_BASED_ENGINE_HPP
+#define BOOST_RANDOM_COMPACT_COUNTER_BASED_ENGINE_HPP
+
+#include <boost/random/counter_based_engine.hpp>
+#include <boost/random/detail/counter_traits.hpp>
+#include <boost/random/detail/operators.hpp>
+#include <boost/integer/static_min_max.hpp>
+#include <boost/integer/static_log2.hpp>
+#include <boost/integer/integer_mask.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/assert.hpp>
+#include <boost/limits.hpp>
+#include <ios>
+#include <iterator>
+#include <stdexcept>
+
+namespace boost{
+namespace random{
+
+// compact_counter_based_engine - a counter_based_engine for code that
+//  keeps very many engines, e.g., one per particle, and touches each
+//  of them only now and then.  It holds just a pointer to a Prf,
+//  which is shared by all the engines with the same key, a counter
+//  and a position in the current block.  It doesn't keep the current
+//  block of results:  operator()() calls the Prf every time, and
+//  fill() calls it once per block.  So, e.g., with threefry<4,
+//  uint64_t>, it's 48 bytes rather than 104, at the cost of calling
+//  the Prf results_per_counter() times as often from operator()().
+//
+//     typedef compact_counter_based_engine<uint64_t, threefry<4, uint64_t> > ceng_t;
+//     const threefry<4, uint64_t> prf = ceng_t::make_prf(key);
+//     std::vector<ceng_t> engines(Nparticles);
+//     for(size_t i=0; i<Nparticles; ++i)
+//         engines[i].seed(prf, make_base(i));
+//
+//  The shared Prf must outlive the engines that refer to it.
+//
+//  It isn't a standard Random Number Engine:  an engine is no use
+//  without a Prf, so there's no seed(), seed(value), seed(SeedSeq&) or
+//  the matching constructors.  Apart from operator()(), min() and
+//  max(), it models only the counter_based_engine extensions -
+//  restart, discard, fill, generate, at and operator[], equality and
+//  streaming.
+//
+//  With a Prf made by make_prf(k), the engine produces exactly the same
+//  sequence as counter_based_engine(k, base) with the same template
+//  arguments, and the two can read each other's streamed state.
+//  (Reading checks that the streamed key is the shared Prf's key, and
+//  sets failbit if it isn't.)
+template<typename UintType,
+         typename Prf,
+         unsigned CtrBits = static_unsigned_min<64u, detail::counter_traits<typename Prf::domain_type>::Nbits/2>::value,
+         unsigned w = std::numeric_limits<UintType>::digits,
+         typename DomainTraits = detail::counter_traits<typename Prf::domain_type>,
+         typename RangeTraits = detail::counter_traits<typename Prf::range_type>,
+         typename KeyTraits = detail::counter_traits<typename Prf::key_type>
+>
+struct compact_counter_based_engine {
+    typedef UintType result_type;
+    BOOST_STATIC_CONSTANT(unsigned, word_size = w);
+    BOOST_STATIC_CONSTANT(bool, has_fixed_range = false);
+
+    typedef Prf prf_type;
+    BOOST_STATIC_CONSTANT(unsigned, counter_bits = CtrBits);
+    typedef typename Prf::domain_type domain_type;
+    typedef typename Prf::range_type range_type;
+    typedef typename Prf::key_type key_type;
+    typedef DomainTraits domain_traits;
+    typedef RangeTraits range_traits;
+    typedef KeyTraits key_traits;
+
+protected:
+    BOOST_STATIC_ASSERT(CtrBits <= DomainTraits::Nbits);
+    BOOST_STATIC_ASSERT(CtrBits > 0);
+    BOOST_STATIC_ASSERT( std::numeric_limits<UintType>::digits >= w );
+    BOOST_STATIC_CONSTANT(unsigned, CtrBitsBits = static_log2<DomainTraits::Nbits>::value);
+
+    // The state is (c, next), exactly as in counter_based_engine,
+    // but without v = (*b)(c).
+    const prf_type* b;
+    domain_type c;
+    unsigned next;
+
+    static domain_type chk_base(domain_type base){
+        domain_type newc = base;
+        if( DomainTraits::template clr_highbits<CtrBits>(base) )
+            BOOST_THROW_EXCEPTION(std::invalid_argument("compact_counter_based_engine base counter overlaps with counter bits"));
+        return newc;
+    }
+
+public:
+    BOOST_RANDOM_DETAIL_CONSTEXPR static result_type min BOOST_PREVENT_MACRO_SUBSTITUTION () { return 0; }
+    BOOST_RANDOM_DETAIL_CONSTEXPR static result_type max BOOST_PREVENT_MACRO_SUBSTITUTION () { return low_bits_mask_t<w>::sig_bits; }
+
+    // make_prf - the Prf that counter_based_engine(k) would use, with
+    //  CtrBits-1 in the high bits of the key (see
+    //  counter_based_engine.hpp).  Like counter_based_engine, it
+    //  throws if those bits of k aren't zero.
+    static prf_type make_prf(key_type k){
+        if( KeyTraits::template clr_highbits<CtrBitsBits>(k) )
+            BOOST_THROW_EXCEPTION(std::invalid_argument("compact_counter_based_engine:: high bits of key are reserved for internal use."));
+        return prf_type(KeyTraits::template incr<CtrBitsBits>(k, CtrBits-1));
+    }
+
+    // A default-constructed engine has no Prf.  It must be seeded
+    // before it's used, which operator()(), fill and at assert.
+    compact_counter_based_engine()
+        : b(0), c(DomainTraits::make_counter()), next(0)
+    {}
+
+    explicit compact_counter_based_engine(const prf_type& shared, domain_type base = DomainTraits::make_counter())
+        : b(&shared), c(chk_base(base)), next(0)
+    {}
+
+    void seed(const prf_type& shared, domain_type base = DomainTraits::make_counter()){
+        c = chk_base(base);
+        b = &shared;
+        next = 0;
+    }
+
+    // restart - as in counter_based_engine.  The shared Prf is
+    //  unchanged.
+    void restart(domain_type base){
+        c = chk_base(base);
+        next = 0;
+    }
+
+    const prf_type& prf() const{
+        BOOST_ASSERT(b);
+        return *b;
+    }
+
+    result_type operator()(){
+        BOOST_ASSERT(b);
+        if( next == results_per_counter() ){
+            c = DomainTraits::template incr<CtrBits>(c);
+            next = 0;
+        }
+        return RangeTraits::template at<result_type, w>(next++, (*b)(c));
+    }
+
+    // discard - exactly as in counter_based_engine, but without
+    //  calling the Prf.
+    void discard(boost::uintmax_t skip){
+        const unsigned Nresult = results_per_counter();
+        unsigned newnext = next + (skip % Nresult);
+        skip /= Nresult;
+        if( newnext > Nresult ){
+            newnext -= Nresult;
+            skip++;
+        }
+        if( newnext==0 && skip ){
+            newnext = Nresult;
+            skip -= 1;
+        }
+        c = DomainTraits::template incr<CtrBits>(c, skip);
+        next = newnext;
+    }
+
+    // fill - as in counter_based_engine, with one call to the Prf per
+    //  block.
+    template <class OutIt>
+    void fill(OutIt first, OutIt last){
+        BOOST_ASSERT(b);
+        const unsigned Nresult = results_per_counter();
+        boost::uintmax_t n = std::distance(first, last);
+        while( n ){
+            if( next == Nresult ){
+                c = DomainTraits::template incr<CtrBits>(c);
+                next = 0;
+            }
+            range_type v = (*b)(c);
+            for( ; n && next < Nresult; --n)
+                *first++ = RangeTraits::template at<result_type, w>(next++, v);
+        }
+    }
+
+    // at and operator[] - as in counter_based_engine.
+    result_type at(boost::uintmax_t n) const{
+        BOOST_ASSERT(b);
+        const unsigned Nresult = results_per_counter();
+        domain_type base = c;
+        DomainTraits::template clr_highbits<CtrBits>(base);
+        return RangeTraits::template at<result_type, w>(static_cast<unsigned>(n%Nresult),
+                                                      (*b)(DomainTraits::template incr<CtrBits>(base, n/Nresult)));
+    }
+
+    result_type operator[](boost::uintmax_t n) const{
+        return at(n);
+    }
+
+    template <class Iter>
+    void generate(Iter first, Iter last)
+    { detail::generate_from_int(*this, first, last); }
+
+    BOOST_RANDOM_DETAIL_CONSTEXPR static unsigned results_per_counter(){
+        return RangeTraits::template size<w>();
+    }
+
+    // Engines are equal if they're in the same position in the
+    // sequence of Prfs with the same key, whether or not they share
+    // the same Prf object.
+    BOOST_RANDOM_DETAIL_EQUALITY_OPERATOR(compact_counter_based_engine, lhs, rhs){
+        return DomainTraits::is_equal(lhs.c, rhs.c) &&
+            lhs.next == rhs.next &&
+            (lhs.b == rhs.b || (lhs.b && rhs.b && *lhs.b == *rhs.b));
+    }
+
+    BOOST_RANDOM_DETAIL_INEQUALITY_OPERATOR(compact_counter_based_engine)
+
+    // The same format as counter_based_engine.
+    BOOST_RANDOM_DETAIL_OSTREAM_OPERATOR(os, compact_counter_based_engine, f){
+        os << (f.next) << ' ';
+        DomainTraits::insert(os, f.c) << ' ';
+        KeyTraits::insert(os, f.prf().getkey());
+        return os;
+    }
+
+    BOOST_RANDOM_DETAIL_ISTREAM_OPERATOR(is, compact_counter_based_engine, f){
+        unsigned newnext;
+        is >> newnext;
+        domain_type newc;
+        DomainTraits::extract(is, newc);
+        key_type newk;
+        KeyTraits::extract(is, newk);
+        if( is ){
+            if( f.b && KeyTraits::is_equal(newk, f.b->getkey()) && newnext <= results_per_counter() ){
+                f.c = newc;
+                f.next = newnext;
+            }else{
+                is.setstate(std::ios_base::failbit);
+            }
+        }
+        return is;
+    }
+};
+
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_COMPACT_COUNTER_BASED_ENGINE_HPP
@@ -17,6 +17,9 @@
 #include <boost/integer/static_log2.hpp>
 #include <boost/integer/integer_mask.hpp>
 #include <boost/random/detail/counter_traits.hpp>
+#include <boost/random/detail/prf_batch.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/assert.hpp>
 
 #include <iosfwd>
 #include <utility>
@@ -36,7 +39,8 @@ template<typename UintType,
          unsigned w = std::numeric_limits<UintType>::digits,
          typename DomainTraits = detail::counter_traits<typename Prf::domain_type>,
          typename RangeTraits = detail::counter_traits<typename Prf::range_type>,
-         typename KeyTraits = detail::counter_traits<typename Prf::key_type>
+         typename KeyTraits = detail::counter_traits<typename Prf::key_type>,
+         bool Lazy = false
 >
 struct counter_based_engine {
     typedef UintType result_type;
@@ -53,6 +57,12 @@ struct counter_based_engine {
     typedef DomainTraits domain_traits;
     typedef RangeTraits range_traits;
     typedef KeyTraits key_traits;
+    // A lazy engine defers the Prf call in its constructors, seed,
+    // restart and operator>> to the first operator()() or fill(),
+    // for code that constructs or copies engines and then reseeds or
+    // restarts them before drawing anything.  It produces the same
+    // values and compares and streams the same way as the eager one.
+    BOOST_STATIC_CONSTANT(bool, lazy = Lazy);
 
 protected:
     BOOST_STATIC_ASSERT(CtrBits <= DomainTraits::Nbits);
@@ -74,6 +84,73 @@ protected:
         next = newnext;
     }
 
+    // In a Lazy engine, the state (newc, 0) is represented by
+    // next == unevaluated, with v not yet computed, and the first
+    // operator()() or fill() computes it.  Since unevaluated >
+    // results_per_counter(), operator()() finds it with the same
+    // comparison it uses to find the end of a block.
+    BOOST_STATIC_CONSTANT(unsigned, unevaluated = ~0u);
+
+    void startctr(domain_type newc){
+        if( Lazy ){
+            c = newc;
+            next = unevaluated;
+        }else{
+            setctr(newc, 0);
+        }
+    }
+
+    void evaluate(){
+        if( Lazy && next == unevaluated )
+            setctr(c, 0);
+    }
+
+    // getnext - the value next would have in an eager engine.
+    unsigned getnext() const{
+        return (Lazy && next == unevaluated) ? 0 : next;
+    }
+
+    // fill_blocks - copy the next nblocks whole blocks to the output,
+    //  leaving next == results_per_counter().  If the Prf has a batch
+    //  operator() (see prf_batch.hpp), the counters are handed to it
+    //  Nbatch at a time.  Otherwise, they're done one at a time.
+    template <class OutIt>
+    OutIt fill_blocks(OutIt first, boost::uintmax_t nblocks, mpl::false_){
+        const unsigned Nresult = results_per_counter();
+        for( ; nblocks; --nblocks){
+            setctr(DomainTraits::template incr<CtrBits>(c), Nresult);
+            for(unsigned i=0; i<Nresult; ++i)
+                *first++ = RangeTraits::template at<result_type, w>(i, v);
+        }
+        return first;
+    }
+
+    template <class OutIt>
+    OutIt fill_blocks(OutIt first, boost::uintmax_t nblocks, mpl::true_){
+        const unsigned Nresult = results_per_counter();
+        static const unsigned Nbatch = 16;
+        domain_type in[Nbatch];
+        range_type out[Nbatch];
+        while( nblocks ){
+            unsigned m = static_cast<unsigned>((std::min)(nblocks, boost::uintmax_t(Nbatch)));
+            // Work on a copy of c, so that if incr runs out of
+            // counters, the engine is left unchanged since the
+            // previous batch.
+            domain_type ctr = c;
+            for(unsigned j=0; j<m; ++j)
+                in[j] = ctr = DomainTraits::template incr<CtrBits>(ctr);
+            detail::prf_batch(b, in, out, m);
+            for(unsigned j=0; j<m; ++j)
+                for(unsigned i=0; i<Nresult; ++i)
+                    *first++ = RangeTraits::template at<result_type, w>(i, out[j]);
+            c = ctr;
+            v = out[m-1];
+            next = Nresult;
+            nblocks -= m;
+        }
+        return first;
+    }
+
     // We avoid collisions between engines with different CtrBits by
     // embedding the value CtrBits-1 in the high few bits of the last
     // element of Prf's key.  If we didn't do this, it would be too
@@ -92,6 +169,10 @@ protected:
         return KeyTraits::template incr<CtrBitsBits>(k, CtrBits-1);
     }
 
+    static bool highbits_clear(domain_type base){
+        return !DomainTraits::template clr_highbits<CtrBits>(base);
+    }
+
     key_type set_highkeybits(key_type k){
         KeyTraits::template clr_highbits<CtrBitsBits>(k);
         return KeyTraits::template incr<CtrBitsBits>(k, CtrBits-1);
@@ -131,28 +212,16 @@ public:
         : b()
     {
         //std::cerr << "cbe()\n";
-        setctr(DomainTraits::make_counter(), 0);
-    }
-
-    counter_based_engine(counter_based_engine& e) 
-        : b(e.b)
-    {
-        //std::cerr << "cbe(counter_based_engine&)\n";
-        setctr(e.c, e.next);
-    }
-
-    counter_based_engine(const counter_based_engine& e) 
-        : b(e.b)
-    {
-        //std::cerr << "cbe(const counter_based_engine&)\n";
-        setctr(e.c,  e.next);
+        startctr(DomainTraits::make_counter());
     }
 
-    counter_based_engine& operator=(const counter_based_engine& rhs){
-        b = rhs.b;
-        setctr(rhs.c, rhs.next);
-        return *this;
-    }
+    // There are no user-provided copy constructors, assignment or
+    // destructor:  if the Prf is trivially copyable, e.g., philox and
+    // threefry, so is the engine, and under C++11 its implicit moves
+    // are trivial and noexcept.  So engines can be memcpy'ed, kept
+    // in shared or mapped memory and relocated by vector without
+    // calling the Prf.  (A copy gets the source's current block, v,
+    // along with its counter.)
 
     // Note that the arithmetic constructor (and seed method, below)
     // takes a uintmax_t, which may be wider than a result_type.
@@ -170,14 +239,14 @@ public:
         : b(chk_highkeybits(KeyTraits::make_counter(value)))
     { 
         //std::cerr << "cbe(result_type)\n";
-        setctr(DomainTraits::make_counter(), 0);
+        startctr(DomainTraits::make_counter());
     }
 
     BOOST_RANDOM_DETAIL_SEED_SEQ_CONSTRUCTOR(counter_based_engine, SeedSeq, seq)
         : b(make_key_from_seedseq(seq))
     {
         //std::cerr << "cbe(SeedSeq)\n";
-        setctr(DomainTraits::make_counter(), 0);
+        startctr(DomainTraits::make_counter());
     }
 
     template<class It> counter_based_engine(It& first, It last)
@@ -186,7 +255,7 @@ public:
         : b(chk_highkeybits(make_key_from_range(first, last, &first)))
     {
         //std::cerr << "cbe(range)\n";
-        setctr(DomainTraits::make_counter(), 0);
+        startctr(DomainTraits::make_counter());
     }
 
     template<class It> counter_based_engine(const It& first, It last)
@@ -195,26 +264,26 @@ public:
         : b(chk_highkeybits(make_key_from_range(first, last, 0)))
     {
         //std::cerr << "cbe(range)\n";
-        setctr(DomainTraits::make_counter(), 0);
+        startctr(DomainTraits::make_counter());
     }
 
     void seed(){
         //std::cerr << "cbe::seed()\n";
         b.setkey(KeyTraits::make_counter());
-        setctr(DomainTraits::make_counter(), 0);
+        startctr(DomainTraits::make_counter());
     }
 
     BOOST_RANDOM_DETAIL_ARITHMETIC_SEED(counter_based_engine, boost::uintmax_t, value)
     { 
         //std::cerr << "cbe::seed(arithmetic)\n";
         b.setkey(chk_highkeybits(KeyTraits::make_counter(value)));
-        setctr(DomainTraits::make_counter(), 0);
+        startctr(DomainTraits::make_counter());
     }
 
     BOOST_RANDOM_DETAIL_SEED_SEQ_SEED(counter_based_engine, SeedSeq, seq){
         //std::cerr << "cbe::seed(SeedSeq)\n" << "\n";
         b.setkey(make_key_from_seedseq(seq));
-        setctr(DomainTraits::make_counter(), 0);
+        startctr(DomainTraits::make_counter());
     }
 
     template<class It>
@@ -224,7 +293,7 @@ public:
         // N.B.  does *NOT* throw if there are non-zero values
         // in the 'leftover' part of the range.  CALLER BEWARE!
         b.setkey(chk_highkeybits(make_key_from_range(first, last, &first)));
-        setctr(DomainTraits::make_counter(), 0);
+        startctr(DomainTraits::make_counter());
     }
 
     template<class It>
@@ -234,19 +303,19 @@ public:
         // N.B.  throws an invalid_argument if there are non-zero
         // values in the 'leftover' part of the range.
         b.setkey(chk_highkeybits(make_key_from_range(first, last, 0)));
-        setctr(DomainTraits::make_counter(), 0);
+        startctr(DomainTraits::make_counter());
     }
 
     BOOST_RANDOM_DETAIL_EQUALITY_OPERATOR(counter_based_engine, lhs, rhs){ 
         return DomainTraits::is_equal(lhs.c, rhs.c) && 
-            lhs.next == rhs.next && 
+            lhs.getnext() == rhs.getnext() && 
             lhs.b == rhs.b; 
     }
 
     BOOST_RANDOM_DETAIL_INEQUALITY_OPERATOR(counter_based_engine)
 
     BOOST_RANDOM_DETAIL_OSTREAM_OPERATOR(os, counter_based_engine, f){
-        os << (f.next) << ' ';
+        os << (f.getnext()) << ' ';
         DomainTraits::insert(os, f.c) << ' ';
         KeyTraits::insert(os,  f.b.getkey());
         return os;
@@ -261,20 +330,27 @@ public:
         KeyTraits::extract(is, newk);
         if( is ){
             f.b.setkey(newk);
-            f.setctr(newc, newnext);
+            if( newnext )
+                f.setctr(newc, newnext);
+            else
+                f.startctr(newc);
         }
         return is;
     }
 
     result_type operator()(){
-        if( next == results_per_counter() )
-            setctr(DomainTraits::template incr<CtrBits>(c), 0);
+        if( next >= results_per_counter() ){
+            if( Lazy && next == unevaluated )
+                setctr(c, 0);
+            else
+                setctr(DomainTraits::template incr<CtrBits>(c), 0);
+        }
         return RangeTraits::template at<result_type, w>(next++, v);
     }
 
     void discard(boost::uintmax_t skip){
         const unsigned Nresult = results_per_counter();
-	unsigned newnext = next + (skip % Nresult);
+	unsigned newnext = getnext() + (skip % Nresult);
         skip /= Nresult;
         if (newnext > Nresult) {
             newnext -= Nresult;
@@ -287,13 +363,80 @@ public:
             newnext = results_per_counter();
             skip -= 1;
         }
-        setctr(DomainTraits::template incr<CtrBits>(c, skip), newnext);
+        if( newnext )
+            setctr(DomainTraits::template incr<CtrBits>(c, skip), newnext);
+        else
+            startctr(c);
+    }
+
+    // at - return the n'th value of the engine's sequence, counting
+    //  from zero at the base counter, i.e., the value that the n+1'st
+    //  call to operator()() after the last seed or restart returns.
+    //  It's computed from the key and the base counter with a single
+    //  call to the Prf, regardless of n or of the engine's current
+    //  position, and the engine is not modified.  So, e.g., many
+    //  threads can look up values by index in a single, shared
+    //  engine.  Like discard, it throws if n is past the end of the
+    //  sequence.  at and operator[] *extend* the standard Random
+    //  Number Engine concept, and they require a const operator() in
+    //  the Prf.
+    result_type at(boost::uintmax_t n) const{
+        const unsigned Nresult = results_per_counter();
+        // The high CtrBits of the base counter are zero, and the
+        // engine keeps its position in them.
+        domain_type base = c;
+        DomainTraits::template clr_highbits<CtrBits>(base);
+        return RangeTraits::template at<result_type, w>(static_cast<unsigned>(n%Nresult),
+                                                      b(DomainTraits::template incr<CtrBits>(base, n/Nresult)));
     }
-         
+
+    result_type operator[](boost::uintmax_t n) const{
+        return at(n);
+    }
+
     template <class Iter>
     void generate(Iter first, Iter last)
     { detail::generate_from_int(*this, first, last); }
 
+    // When w==32, generate_from_int just copies successive outputs of
+    // operator()() into the output range, so we can take the fast
+    // path through fill.  Other word sizes are packed or split into
+    // 32-bit values by generate_from_int, so they take the slow path.
+    void generate(result_type* first, result_type* last){
+        if( w == 32 )
+            fill(first, last);
+        else
+            detail::generate_from_int(*this, first, last);
+    }
+
+    // fill - assign the next std::distance(first, last) values of the
+    //  sequence to the range [first, last).  The result is identical
+    //  to assigning successive values of operator()(), and the engine
+    //  is left in the same state, but whole blocks of the Prf's
+    //  range_type are copied to the output without re-checking next
+    //  on every element, and if the Prf has a batch operator(), the
+    //  whole blocks are computed by it.  Fill is an extension of the
+    //  standard Random Number Engine concept.
+    template <class OutIt>
+    void fill(OutIt first, OutIt last){
+        const unsigned Nresult = results_per_counter();
+        boost::uintmax_t n = std::distance(first, last);
+        if( n )
+            evaluate();
+        // Finish off the current block.
+        for( ; n && next < Nresult; --n)
+            *first++ = RangeTraits::template at<result_type, w>(next++, v);
+        // Whole blocks.
+        first = fill_blocks(first, n/Nresult, mpl::bool_<detail::has_batch_operator<Prf>::value>());
+        n %= Nresult;
+        // And a partial block at the end.
+        if( n ){
+            setctr(DomainTraits::template incr<CtrBits>(c), 0);
+            while( n-- )
+                *first++ = RangeTraits::template at<result_type, w>(next++, v);
+        }
+    }
+
     // The member functions below *extend* the standard Random Number
     // Engine concept.  
     //
@@ -312,7 +455,7 @@ public:
         if( DomainTraits::template clr_highbits<CtrBits>(base) )
             BOOST_THROW_EXCEPTION(std::invalid_argument("counter_based_engine:: high bits of key are reserved for internal use."));
             
-        setctr(base, 0);
+        startctr(base);
     }
 
 #if !defined(BOOST_NO_CXX11_HDR_INITIALIZER_LIST)
@@ -322,19 +465,70 @@ public:
     }
 #endif
 
+    // restart_unchecked - restart, for callers that know that the
+    //  high CtrBits of base are zero, e.g., because they built it
+    //  from values that are known to be small enough.  The check is a
+    //  BOOST_ASSERT, so it costs nothing in a release build, but if
+    //  the bits aren't zero, the engine's sequence overlaps the
+    //  sequences of other base counters.
+    void restart_unchecked(domain_type base){
+        BOOST_ASSERT(highbits_clear(base));
+        startctr(base);
+    }
+
+    // restart_and_draw - restart_unchecked(base), followed by N calls
+    //  to operator()(), with the results assigned to *out++.  It
+    //  leaves the engine in exactly the same state, but the checks in
+    //  operator()() are resolved at compile time, and the Prf is
+    //  called only once per results_per_counter() values.  It's meant
+    //  for code that restarts once per item and draws just a few
+    //  values each time, e.g., one per atom and time step:
+    //
+    //     result_type r[3];
+    //     eng.restart_and_draw<3>(make_base(atom.id, step), r);
+    //
+    //  Returns the final value of out.  restart_and_draw<0> is just
+    //  restart_unchecked, so in a Lazy engine it doesn't call the Prf.
+    template <unsigned N, class OutIt>
+    OutIt restart_and_draw(domain_type base, OutIt out){
+        BOOST_ASSERT(highbits_clear(base));
+        if( N == 0 ){
+            startctr(base);
+            return out;
+        }
+        const unsigned Nresult = results_per_counter();
+        c = base;
+        v = b(c);
+        unsigned i = 0;
+        for(unsigned j=0; j<N; ++j){
+            if( i == Nresult ){
+                c = DomainTraits::template incr<CtrBits>(c);
+                v = b(c);
+                i = 0;
+            }
+            *out++ = RangeTraits::template at<result_type, w>(i++, v);
+        }
+        next = i;
+        return out;
+    }
+
     // Constructor and seed() method to construct or re-seed a
     // counter_based_engine from a key or a Prf and an optional base
     // counter.
     explicit counter_based_engine(key_type k, domain_type base = DomainTraits::make_counter()) : 
-        b(chk_highkeybits(k)), c(base), next(){
+        b(chk_highkeybits(k)){
+        domain_type newc = base;
         if( DomainTraits::template clr_highbits<CtrBits>(base) )
             BOOST_THROW_EXCEPTION(std::invalid_argument("counter_based_engine base counter overlaps with counter bits"));
+        startctr(newc);
     }
 
-    explicit counter_based_engine(const Prf& _b, domain_type base = DomainTraits::make_counter()) : b(_b), c(base), next(){
+    explicit counter_based_engine(const Prf& _b, domain_type base = DomainTraits::make_counter()) : b(_b){
         chk_highkeybits(b.getkey());
-        if( DomainTraits::clr_highbits<CtrBits>(base) )
+        domain_type newc = base;
+        if( DomainTraits::template clr_highbits<CtrBits>(base) )
             BOOST_THROW_EXCEPTION(std::invalid_argument("counter_based_engine base counter overlaps with counter bits"));
+        startctr(newc);
     }
 
     void seed(key_type k, domain_type base){
@@ -350,7 +544,9 @@ public:
     // results_per_counter - returns the number of random results made
     //  available by each invocation of the prf.  The total length of
     //  the sequence is results_per_counter() * 2^counter_bits.
-    static unsigned results_per_counter(){
+    //  It's constexpr (or at least const and always inlined, pre-C++11),
+    //  so operator()(), discard(), etc. divide by a constant.
+    BOOST_RANDOM_DETAIL_CONSTEXPR static unsigned results_per_counter(){
         return RangeTraits::template size<w>();
     }
 };
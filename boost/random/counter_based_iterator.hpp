@@ -0,0 +1,115 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_COUNTER_BASED_ITERATOR_HPP
+#define BOOST_RANDOM_COUNTER_BASED_ITERATOR_HPP
+
+#include <boost/cstdint.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <iterator>
+
+namespace boost{
+namespace random{
+
+// counter_based_iterator - a random access iterator over the output
+//  sequence of a counter_based_engine (or a
+//  buffered_counter_based_engine).  The iterator at index n refers to
+//  engine.at(n), i.e., the n'th value that the engine's operator()()
+//  produces after a seed or restart.  Dereferencing costs one call to
+//  the engine's Prf, and moving the iterator any distance is just an
+//  addition, so a range of them can be split into chunks anywhere,
+//  and the chunks handed to different threads, e.g., by a parallel
+//  std::copy or std::transform, or an OpenMP loop over the index.
+//  Whatever the chunking, the values are exactly those of the serial
+//  stream.
+//
+//  The iterator refers to the engine by pointer and never modifies
+//  it.  The engine must outlive the iterator, and it must not be
+//  re-seeded or restarted while the iterator is in use.  Iterators
+//  compare by index alone - comparing iterators over different
+//  engines is meaningless.
+//
+//  operator*() returns a value rather than a reference, as
+//  counting_iterator and transform_iterator do.  Strictly speaking,
+//  that makes it a random access *traversal* iterator, but it's
+//  labeled std::random_access_iterator_tag, which is what the standard
+//  algorithms, including the parallel ones, dispatch on.
+//
+//  Each value is computed from its own Prf call, so an iterator over a
+//  Prf with, e.g., four results per counter does four times the work
+//  of the engine's fill().  That's the price of being able to start
+//  anywhere.  Code that hands out big chunks should consider a copy
+//  of the engine, discard() and fill() in each chunk.
+template <typename Engine>
+class counter_based_iterator{
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename Engine::result_type value_type;
+    typedef boost::intmax_t difference_type;
+    typedef const value_type* pointer;
+    typedef value_type reference;
+
+    counter_based_iterator() : e(), n() {}
+    counter_based_iterator(const Engine& _e, boost::uintmax_t _n) : e(&_e), n(_n) {}
+
+    // index - the position in the engine's sequence.
+    boost::uintmax_t index() const { return n; }
+
+    reference operator*() const { return e->at(n); }
+    reference operator[](difference_type d) const { return e->at(n + d); }
+
+    counter_based_iterator& operator++(){ ++n; return *this; }
+    counter_based_iterator& operator--(){ --n; return *this; }
+    counter_based_iterator operator++(int){ counter_based_iterator t(*this); ++n; return t; }
+    counter_based_iterator operator--(int){ counter_based_iterator t(*this); --n; return t; }
+    counter_based_iterator& operator+=(difference_type d){ n += d; return *this; }
+    counter_based_iterator& operator-=(difference_type d){ n -= d; return *this; }
+
+    friend counter_based_iterator operator+(counter_based_iterator i, difference_type d){ return i += d; }
+    friend counter_based_iterator operator+(difference_type d, counter_based_iterator i){ return i += d; }
+    friend counter_based_iterator operator-(counter_based_iterator i, difference_type d){ return i -= d; }
+    friend difference_type operator-(const counter_based_iterator& lhs, const counter_based_iterator& rhs){
+        return static_cast<difference_type>(lhs.n - rhs.n);
+    }
+
+    friend bool operator==(const counter_based_iterator& lhs, const counter_based_iterator& rhs){ return lhs.n == rhs.n; }
+    friend bool operator!=(const counter_based_iterator& lhs, const counter_based_iterator& rhs){ return lhs.n != rhs.n; }
+    friend bool operator<(const counter_based_iterator& lhs, const counter_based_iterator& rhs){ return lhs.n < rhs.n; }
+    friend bool operator>(const counter_based_iterator& lhs, const counter_based_iterator& rhs){ return lhs.n > rhs.n; }
+    friend bool operator<=(const counter_based_iterator& lhs, const counter_based_iterator& rhs){ return lhs.n <= rhs.n; }
+    friend bool operator>=(const counter_based_iterator& lhs, const counter_based_iterator& rhs){ return lhs.n >= rhs.n; }
+
+protected:
+    const Engine* e;
+    boost::uintmax_t n;
+};
+
+// stream_range - the values of the engine's sequence with indices in
+//  [first, last), or [0, n), as a range of counter_based_iterators.
+//  E.g.,
+//
+//     std::copy(std::execution::par_unseq,
+//               boost::begin(stream_range(eng, N)),
+//               boost::end(stream_range(eng, N)), v.begin());
+//
+//  fills v with the same N values as N calls to eng() right after
+//  its last seed or restart, without modifying eng.
+template <typename Engine>
+iterator_range<counter_based_iterator<Engine> >
+stream_range(const Engine& e, boost::uintmax_t first, boost::uintmax_t last){
+    return iterator_range<counter_based_iterator<Engine> >(counter_based_iterator<Engine>(e, first),
+                                                           counter_based_iterator<Engine>(e, last));
+}
+
+template <typename Engine>
+iterator_range<counter_based_iterator<Engine> >
+stream_range(const Engine& e, boost::uintmax_t n){
+    return stream_range(e, 0, n);
+}
+
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_COUNTER_BASED_ITERATOR_HPP
@@ -0,0 +1,206 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_AES_ROUND_HPP
+#define BOOST_RANDOM_DETAIL_AES_ROUND_HPP
+
+// AES rounds for the AES-based Prfs (ars.hpp).  A 128-bit AES state
+// is a boost::array<uint64_t, 2>, with the state's bytes 0..7 in the
+// little-endian order of word 0 and bytes 8..15 in word 1, which is
+// exactly how an __m128i holds them on x86.
+//
+//   aes_round(s, k)       = MixColumns(ShiftRows(SubBytes(s))) ^ k
+//   aes_round_last(s, k)  = ShiftRows(SubBytes(s)) ^ k
+//
+// i.e., the same functions as the AES-NI instructions aesenc and
+// aesenclast.  These are the portable versions, in plain C++ with no
+// lookup tables:  SubBytes computes the S-box, an inverse in GF(2^8)
+// followed by an affine map, eight bytes at a time in a uint64_t.
+// They're much slower than the instructions, but bit-identical.
+//
+// BOOST_RANDOM_HAVE_AESNI is defined when the compiler can compile
+// the AES-NI instructions whether or not the target is known to
+// have them (with gcc's and clang's target attribute, or with MSVC).
+// cpu_features().aes says whether it's safe to call them.  Likewise,
+// BOOST_RANDOM_HAVE_VAES for the 512-bit VAES instructions, which do
+// four blocks at once, and cpu_features().vaes.  Define
+// BOOST_RANDOM_NO_AESNI to leave them out altogether.
+
+#include <boost/config.hpp>
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/detail/cpu_features.hpp>
+
+#if !defined(BOOST_RANDOM_NO_AESNI)
+#if defined(BOOST_RANDOM_DETAIL_CPUID_GNUC) && (defined(__clang__) || __GNUC__ >= 5)
+#include <immintrin.h>
+#define BOOST_RANDOM_HAVE_AESNI
+#define BOOST_RANDOM_DETAIL_AESNI_TARGET __attribute__((target("aes,sse2")))
+#elif defined(BOOST_RANDOM_DETAIL_CPUID_MSVC) && _MSC_VER >= 1900
+#include <immintrin.h>
+#define BOOST_RANDOM_HAVE_AESNI
+#define BOOST_RANDOM_DETAIL_AESNI_TARGET
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+#if defined(BOOST_RANDOM_DETAIL_CPUID_GNUC) && ((defined(__clang__) && __clang_major__ >= 7) || (!defined(__clang__) && __GNUC__ >= 8))
+#define BOOST_RANDOM_HAVE_VAES
+#define BOOST_RANDOM_DETAIL_VAES_TARGET __attribute__((target("vaes,avx512f")))
+#elif defined(BOOST_RANDOM_DETAIL_CPUID_MSVC) && _MSC_VER >= 1920
+#define BOOST_RANDOM_HAVE_VAES
+#define BOOST_RANDOM_DETAIL_VAES_TARGET
+#endif
+#endif
+#endif // BOOST_RANDOM_NO_AESNI
+
+namespace boost{
+namespace random{
+namespace detail{
+
+typedef boost::array<uint64_t, 2> aes_block;
+
+// Byte-parallel GF(2^8) arithmetic, modulo the AES polynomial
+// x^8+x^4+x^3+x+1, on the eight bytes of a uint64_t.
+inline uint64_t gf8_xtime(uint64_t x){
+    const uint64_t lo7 = UINT64_C(0x7f7f7f7f7f7f7f7f);
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    return ((x & lo7) << 1) ^ (((x >> 7) & ones) * 0x1b);
+}
+
+inline uint64_t gf8_mul(uint64_t a, uint64_t b){
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    uint64_t r = 0;
+    for(unsigned i=0; i<8; ++i){
+        r ^= a & (((b >> i) & ones) * 0xff);
+        a = gf8_xtime(a);
+    }
+    return r;
+}
+
+// x^254, which is x^-1 for x != 0, and 0 for x == 0.
+inline uint64_t gf8_inv(uint64_t x){
+    uint64_t x2 = gf8_mul(x, x);
+    uint64_t x3 = gf8_mul(x2, x);
+    uint64_t x12 = gf8_mul(x3, x3);
+    x12 = gf8_mul(x12, x12);
+    uint64_t x15 = gf8_mul(x12, x3);
+    uint64_t x240 = x15;
+    for(unsigned i=0; i<4; ++i)
+        x240 = gf8_mul(x240, x240);
+    return gf8_mul(gf8_mul(x240, x12), x2);
+}
+
+// Rotate each byte left by s bits.
+inline uint64_t bytes_rotl(uint64_t x, unsigned s){
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    uint64_t lomask = ((0xffu << s) & 0xff) * ones;
+    return ((x << s) & lomask) | ((x >> (8-s)) & ~lomask);
+}
+
+// The AES S-box on each byte.
+inline uint64_t aes_subbytes(uint64_t x){
+    uint64_t y = gf8_inv(x);
+    return y ^ bytes_rotl(y, 1) ^ bytes_rotl(y, 2) ^ bytes_rotl(y, 3) ^ bytes_rotl(y, 4) ^ UINT64_C(0x6363636363636363);
+}
+
+// ShiftRows.  Byte 4*c+r of the state is row r, column c, and row r
+// is rotated left by r columns.
+inline aes_block aes_shiftrows(const aes_block& s){
+    unsigned char in[16], out[16];
+    for(unsigned i=0; i<16; ++i)
+        in[i] = (s[i/8] >> (8*(i%8))) & 0xff;
+    for(unsigned c=0; c<4; ++c)
+        for(unsigned r=0; r<4; ++r)
+            out[4*c+r] = in[4*((c+r)&3)+r];
+    aes_block ret = {{0, 0}};
+    for(unsigned i=0; i<16; ++i)
+        ret[i/8] |= uint64_t(out[i]) << (8*(i%8));
+    return ret;
+}
+
+// MixColumns on the two columns in a uint64_t.  With row r of a
+// column in byte r of a 32-bit word, rotating the word right by 8
+// bits brings row r+1 into row r's place, so
+//   b[r] = 2*a[r] ^ 3*a[r+1] ^ a[r+2] ^ a[r+3]
+// is this:
+inline uint64_t aes_mixcolumns(uint64_t a){
+    const uint64_t lo24 = UINT64_C(0x00ffffff00ffffff);
+    const uint64_t lo16 = UINT64_C(0x0000ffff0000ffff);
+    const uint64_t lo8 = UINT64_C(0x000000ff000000ff);
+    uint64_t a1 = ((a >> 8) & lo24) | ((a << 24) & ~lo24);
+    uint64_t a2 = ((a >> 16) & lo16) | ((a << 16) & ~lo16);
+    uint64_t a3 = ((a >> 24) & lo8) | ((a << 8) & ~lo8);
+    return gf8_xtime(a ^ a1) ^ a1 ^ a2 ^ a3;
+}
+
+inline aes_block aes_round_last(const aes_block& s, const aes_block& k){
+    aes_block t = aes_shiftrows(s);
+    aes_block ret = {{aes_subbytes(t[0]) ^ k[0], aes_subbytes(t[1]) ^ k[1]}};
+    return ret;
+}
+
+inline aes_block aes_round(const aes_block& s, const aes_block& k){
+    aes_block t = aes_shiftrows(s);
+    aes_block ret = {{aes_mixcolumns(aes_subbytes(t[0])) ^ k[0],
+                      aes_mixcolumns(aes_subbytes(t[1])) ^ k[1]}};
+    return ret;
+}
+
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+// aes_load and aes_store move the words through general registers
+// rather than memory.  An aes_block is usually in registers already,
+// and storing it as two words and reloading it as one __m128i (or
+// vice versa) stalls store-to-load forwarding, which costs more than
+// all of ars_prf's rounds.
+#if defined(__x86_64__) || defined(_M_X64)
+BOOST_RANDOM_DETAIL_AESNI_TARGET
+inline __m128i aes_load(const aes_block& b){
+    return _mm_unpacklo_epi64(_mm_cvtsi64_si128(b[0]), _mm_cvtsi64_si128(b[1]));
+}
+
+BOOST_RANDOM_DETAIL_AESNI_TARGET
+inline aes_block aes_store(__m128i m){
+    aes_block b = {{uint64_t(_mm_cvtsi128_si64(m)),
+                    uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(m, m)))}};
+    return b;
+}
+#else
+BOOST_RANDOM_DETAIL_AESNI_TARGET
+inline __m128i aes_load(const aes_block& b){
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(b.data()));
+}
+
+BOOST_RANDOM_DETAIL_AESNI_TARGET
+inline aes_block aes_store(__m128i m){
+    aes_block b;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(b.data()), m);
+    return b;
+}
+#endif
+#endif // BOOST_RANDOM_HAVE_AESNI
+
+// aes_has_aesni() - whether the AES-NI kernels may be called.
+inline bool aes_has_aesni(){
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+    return cpu_features().aes;
+#else
+    return false;
+#endif
+}
+
+// aes_has_vaes() - whether the 512-bit VAES kernels may be called.
+inline bool aes_has_vaes(){
+#if defined(BOOST_RANDOM_HAVE_VAES)
+    return cpu_features().vaes;
+#else
+    return false;
+#endif
+}
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_AES_ROUND_HPP
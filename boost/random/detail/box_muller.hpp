@@ -0,0 +1,189 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_BOX_MULLER_HPP
+#define BOOST_RANDOM_DETAIL_BOX_MULLER_HPP
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/fill_uniform01.hpp>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+namespace detail{
+
+// The pieces of a Box-Muller transform that's written to be
+// vectorized by the compiler:  box_muller_group converts G pairs of
+// random words to G pairs of normals with nothing but straight-line
+// arithmetic, bit-twiddling and selects in loops with a compile-time
+// trip count.  There are no calls to the library's log, sin or cos -
+// which are scalar, and whose results vary from one libm to another -
+// but polynomial approximations good to a few ulps, below.  Every
+// value is computed by the same code, whether the compiler uses 4,
+// 8 or 16 lanes, or none.
+//
+// box_muller_math<Real> provides:
+//
+//   log(u)  for u in (0, 1], by splitting off the exponent, so that
+//           u = 2^e * m with m in [sqrt(1/2), sqrt(2)), and the series
+//           log(m) = 2*atanh(s) = 2*(s + s^3/3 + s^5/5 + ...), with
+//           s = (m-1)/(m+1), |s| < 0.172.
+//   sincos2pi(u, &s, &c)  for u in [0, 1), by reducing u to the
+//           nearest quarter turn, which is exact, and Taylor series
+//           on [-pi/4, pi/4].
+//   sqrt(x) for x >= 0, by Newton's iteration for 1/sqrt(x) from the
+//           well-known bit-twiddled first guess.  std::sqrt would be
+//           correctly rounded, but unless the compiler is told
+//           -fno-math-errno, it has to keep a call to the library
+//           for negative arguments, and that stops it vectorizing the
+//           loop.
+template <typename Real>
+struct box_muller_math;
+
+template <>
+struct box_muller_math<float>{
+    typedef uint32_t bits_type;
+    static BOOST_FORCEINLINE float log(float u){
+        const uint32_t sqrthalf = 0x3f3504f3u;
+        uint32_t i;
+        std::memcpy(&i, &u, sizeof(i));
+        i += 0x3f800000u - sqrthalf;
+        int e = int(i >> 23) - 127;
+        i = (i & 0x007fffffu) + sqrthalf;
+        float m;
+        std::memcpy(&m, &i, sizeof(m));
+        float s = (m - 1.f)/(m + 1.f);
+        float s2 = s*s;
+        float p = s2*(1.f/3 + s2*(1.f/5 + s2*(1.f/7 + s2*(1.f/9))));
+        return float(e)*0.693147180559945309f + (2.f*s + 2.f*s*p);
+    }
+
+    static BOOST_FORCEINLINE float sqrt(float x){
+        uint32_t i;
+        std::memcpy(&i, &x, sizeof(i));
+        i = 0x5f3759dfu - (i >> 1);
+        float y;
+        std::memcpy(&y, &i, sizeof(y));
+        float hx = 0.5f*x;
+        y = y*(1.5f - hx*y*y);
+        y = y*(1.5f - hx*y*y);
+        y = y*(1.5f - hx*y*y);
+        return x*y;
+    }
+
+    static BOOST_FORCEINLINE void sincos2pi(float u, float* sp, float* cp){
+        int q = int(4.f*u + 0.5f);
+        float x = (u - 0.25f*float(q)) * 6.28318530717958648f;
+        float x2 = x*x;
+        float s = x + x*x2*(-1.f/6 + x2*(1.f/120 + x2*(-1.f/5040 + x2*(1.f/362880))));
+        float c = 1.f - 0.5f*x2 + x2*x2*(1.f/24 + x2*(-1.f/720 + x2*(1.f/40320 + x2*(-1.f/3628800))));
+        rotate(q, s, c, sp, cp);
+    }
+
+    template <typename T>
+    static BOOST_FORCEINLINE void rotate(int q, T s, T c, T* sp, T* cp){
+        // (s, c) are sin and cos of the angle less q quarter turns.
+        q &= 3;
+        T ss = (q&1) ? c : s;
+        T cc = (q&1) ? s : c;
+        *sp = (q&2) ? -ss : ss;
+        *cp = ((q+1)&2) ? -cc : cc;
+    }
+};
+
+template <>
+struct box_muller_math<double>{
+    typedef uint64_t bits_type;
+    static BOOST_FORCEINLINE double log(double u){
+        const uint64_t sqrthalf = UINT64_C(0x3fe6a09e667f3bcd);
+        uint64_t i;
+        std::memcpy(&i, &u, sizeof(i));
+        i += UINT64_C(0x3ff0000000000000) - sqrthalf;
+        int e = int(i >> 52) - 1023;
+        i = (i & UINT64_C(0x000fffffffffffff)) + sqrthalf;
+        double m;
+        std::memcpy(&m, &i, sizeof(m));
+        double s = (m - 1.)/(m + 1.);
+        double s2 = s*s;
+        double p = s2*(1./3 + s2*(1./5 + s2*(1./7 + s2*(1./9 + s2*(1./11 + s2*(1./13 +
+                   s2*(1./15 + s2*(1./17 + s2*(1./19)))))))));
+        return double(e)*0.693147180559945309417 + (2.*s + 2.*s*p);
+    }
+
+    static BOOST_FORCEINLINE double sqrt(double x){
+        uint64_t i;
+        std::memcpy(&i, &x, sizeof(i));
+        i = UINT64_C(0x5fe6eb50c7b537a9) - (i >> 1);
+        double y;
+        std::memcpy(&y, &i, sizeof(y));
+        double hx = 0.5*x;
+        y = y*(1.5 - hx*y*y);
+        y = y*(1.5 - hx*y*y);
+        y = y*(1.5 - hx*y*y);
+        y = y*(1.5 - hx*y*y);
+        return x*y;
+    }
+
+    static BOOST_FORCEINLINE void sincos2pi(double u, double* sp, double* cp){
+        int q = int(4.*u + 0.5);
+        double x = (u - 0.25*double(q)) * 6.28318530717958647693;
+        double x2 = x*x;
+        double s = x + x*x2*(-1./6 + x2*(1./120 + x2*(-1./5040 + x2*(1./362880 +
+                   x2*(-1./39916800 + x2*(1./6227020800. + x2*(-1./1307674368000. +
+                   x2*(1./355687428096000.))))))));
+        double c = 1. - 0.5*x2 + x2*x2*(1./24 + x2*(-1./720 + x2*(1./40320 + x2*(-1./3628800 +
+                   x2*(1./479001600 + x2*(-1./87178291200. + x2*(1./20922789888000.)))))));
+        box_muller_math<float>::rotate(q, s, c, sp, cp);
+    }
+};
+
+// box_muller_group - out[2i] and out[2i+1] are the two normals made
+//  from the words in[2i] and in[2i+1], for i in [0, G):  with u1 in
+//  (0, 1] from in[2i] and u2 in [0, 1) from in[2i+1], both converted
+//  as by fill_uniform01,
+//
+//     out[2i]   = mean + sigma * sqrt(-2 log u1) * cos(2 pi u2)
+//     out[2i+1] = mean + sigma * sqrt(-2 log u1) * sin(2 pi u2)
+//
+//  Since u1 >= 2^-p, where p is the number of random bits per
+//  uniform (see uniform01_converter), the magnitude of the normals is
+//  at most sqrt(2 p log 2), e.g., 5.8 for floats and 8.6 for doubles
+//  from 64-bit words.
+template <typename Real, typename Uint, unsigned w>
+struct box_muller_group{
+    BOOST_STATIC_CONSTANT(std::size_t, G = 64);
+    typedef box_muller_math<Real> math;
+
+    BOOST_FORCEINLINE void operator()(const Uint* in, Real* out, Real mean, Real sigma) const{
+        // Each step is its own loop over the group, with no strided
+        // accesses but the first and the last, which is what gcc's
+        // vectorizer likes best.
+        Real u1[G], u2[G], r[G], s[G], c[G];
+        for(std::size_t i=0; i<G; ++i){
+            u1[i] = conv1(in[2*i]);
+            u2[i] = conv2(in[2*i+1]);
+        }
+        for(std::size_t i=0; i<G; ++i)
+            r[i] = math::sqrt(Real(-2)*math::log(u1[i]));
+        for(std::size_t i=0; i<G; ++i)
+            math::sincos2pi(u2[i], &s[i], &c[i]);
+        for(std::size_t i=0; i<G; ++i){
+            out[2*i] = mean + sigma*(r[i]*c[i]);
+            out[2*i+1] = mean + sigma*(r[i]*s[i]);
+        }
+    }
+
+    uniform01_converter<Real, Uint, w, u01_open_closed> conv1;
+    uniform01_converter<Real, Uint, w, u01_closed_open> conv2;
+};
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_BOX_MULLER_HPP
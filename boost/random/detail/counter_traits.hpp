@@ -24,7 +24,7 @@
 
 namespace boost{
 namespace random{
-template <typename, typename, unsigned, unsigned, typename, typename, typename>
+template <typename, typename, unsigned, unsigned, typename, typename, typename, bool>
 struct counter_based_engine;
 namespace detail{
 
@@ -38,7 +38,8 @@ namespace detail{
 //         unsigned w = std::numeric_limits<UintType>::digits,
 //         typename DomainTraits = detail::counter_traits<typename Prf::domain_type>,
 //         typename RangeTraits = detail::counter_traits<typename Prf::range_type>,
-//         typename KeyTraits = detail::counter_traits<typename Prf::key_type>
+//         typename KeyTraits = detail::counter_traits<typename Prf::key_type>,
+//         bool Lazy = false
 //>
 // struct counter_based_engine{...};
 //
@@ -94,8 +95,16 @@ struct counter_traits{
     template <unsigned HighBits>
     static CtrType incr(CtrType d, boost::uintmax_t n);
 
+    // try_incr - like incr, but rather than throwing when we've run
+    //  out of counters, it returns false and leaves d unchanged.
+    template <unsigned HighBits>
+    static bool try_incr(CtrType& d);
+
+    // size - the number of w-bit results in a CtrType.  Declare it
+    //  BOOST_RANDOM_DETAIL_CONSTEXPR, so that it can be a constant
+    //  expression.
     template <unsigned w>
-    static std::size_t size();
+    BOOST_RANDOM_DETAIL_CONSTEXPR static std::size_t size();
 
     template <typename result_type, unsigned w>
     static result_type at(std::size_t n, CtrType v);
@@ -114,7 +123,7 @@ struct counter_traits{
 protected:
     template <typename SeedSeq>
     static CtrType _make_counter_from_seedseq(SeedSeq& s);
-    template <typename, typename, unsigned, unsigned, typename, typename, typename>
+    template <typename, typename, unsigned, unsigned, typename, typename, typename, bool>
     friend struct ::boost::random::counter_based_engine;
 };
 
@@ -314,22 +323,33 @@ public:
 
     template <unsigned HighBits>
     static CtrType incr(CtrType d){
+        if( !try_incr<HighBits>(d) )
+            BOOST_THROW_EXCEPTION(std::invalid_argument("counter_traits::incr(): ran out of counters"));
+        return d;
+    }
+
+    template <unsigned HighBits>
+    static bool try_incr(CtrType& d){
         BOOST_STATIC_ASSERT(HighBits <= Nbits);
         BOOST_STATIC_ASSERT(HighBits > 0);
         BOOST_STATIC_CONSTANT(T, incr_stride = T(1)<<((Nbits - HighBits)%value_bits));
         BOOST_STATIC_CONSTANT(unsigned, FullCtrWords = HighBits/value_bits);
-        typename CtrType::reverse_iterator p = d.rbegin();
+        CtrType e = d;
+        typename CtrType::reverse_iterator p = e.rbegin();
         for(unsigned i=0; i<FullCtrWords; ++i){
             *p += 1;
-            if(*p++)
-                return d;
+            if(*p++){
+                d = e;
+                return true;
+            }
         }
-        if(p == d.rend())
-            BOOST_THROW_EXCEPTION(std::invalid_argument("counter_traits::incr(): ran out of counters"));
+        if(p == e.rend())
+            return false;
         *p += incr_stride;
         if(*p < incr_stride)
-            BOOST_THROW_EXCEPTION(std::invalid_argument("counter_traits::incr(): ran out of counters"));
-        return d;
+            return false;
+        d = e;
+        return true;
     }
 
     template <unsigned HighBits>
@@ -360,12 +380,8 @@ public:
     }
 
     template <unsigned w>
-    static std::size_t size(){
-        if( w <= value_bits ){
-            return N*( value_bits/w );
-        }else{
-            return N/ ((w+value_bits-1)/value_bits);
-        }
+    BOOST_RANDOM_DETAIL_CONSTEXPR static std::size_t size(){
+        return (w <= value_bits) ? N*(value_bits/w) : N/((w+value_bits-1)/value_bits);
     }
 
     template <typename result_type, unsigned w>
@@ -402,7 +418,7 @@ protected:
         detail::seed_array_int<value_bits>(s, ret.elems);
         return ret;
     }
-    template <typename, typename, unsigned, unsigned, typename, typename, typename>
+    template <typename, typename, unsigned, unsigned, typename, typename, typename, bool>
     friend struct ::boost::random::counter_based_engine;
 };
 
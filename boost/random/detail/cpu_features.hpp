@@ -0,0 +1,210 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_CPU_FEATURES_HPP
+#define BOOST_RANDOM_DETAIL_CPU_FEATURES_HPP
+
+// cpu_features() - what the CPU we're running on can do, as opposed
+// to what the compiler was told it could do (-march, -mavx2, etc.).
+// It's for kernels that are compiled for an instruction set the
+// target isn't guaranteed to have (with gcc's and clang's
+// __attribute__((target(...))), or with MSVC, which doesn't need
+// one), and that must check before they're called.
+//
+// The CPU is probed once, the first time cpu_features() is called.
+// On anything other than x86, or with a compiler we don't know how to
+// ask, a feature is reported as present only if the compiler was told
+// the target has it.
+//
+// The environment variable BOOST_RANDOM_SIMD caps what's reported, e.g.,
+// to compare the kernels on one machine, or to work around a broken
+// one.  It's one of
+//
+//   scalar  no SIMD kernels at all, and no AES-NI or SHA-NI either.
+//   sse4.1  SSE4.1, AES-NI and SHA-NI.
+//   avx2    and AVX2.
+//   avx512  and AVX-512F, AVX-512DQ and VAES, i.e., everything.
+//
+// It can only take features away:  asking for avx512 on a CPU that
+// only has AVX2 gets AVX2.  Anything else, including an empty value,
+// is ignored.  Like the probe, it's read once.
+
+#include <boost/config.hpp>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define BOOST_RANDOM_DETAIL_CPUID_GNUC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define BOOST_RANDOM_DETAIL_CPUID_MSVC
+#endif
+
+namespace boost{
+namespace random{
+namespace detail{
+
+struct cpu_feature_flags{
+    bool sse41;
+    bool aes;
+    bool sha;
+    bool avx2;
+    bool avx512f;
+    bool avx512dq;
+    bool vaes;
+};
+
+// simd_level - the instruction sets the multi-lane kernels are written
+// for, in increasing order.  simd_avx512 means AVX-512F and AVX-512DQ.
+enum simd_level{
+    simd_scalar,
+    simd_sse41,
+    simd_avx2,
+    simd_avx512
+};
+
+inline void cpuid_count(unsigned leaf, unsigned subleaf, unsigned (&r)[4]){
+    r[0] = r[1] = r[2] = r[3] = 0;
+#if defined(BOOST_RANDOM_DETAIL_CPUID_GNUC)
+    if( __get_cpuid_max(0, 0) >= leaf )
+        __cpuid_count(leaf, subleaf, r[0], r[1], r[2], r[3]);
+#elif defined(BOOST_RANDOM_DETAIL_CPUID_MSVC)
+    int regs[4];
+    __cpuid(regs, 0);
+    if( unsigned(regs[0]) >= leaf ){
+        __cpuidex(regs, leaf, subleaf);
+        for(unsigned i=0; i<4; ++i)
+            r[i] = regs[i];
+    }
+#else
+    (void)leaf; (void)subleaf;
+#endif
+}
+
+// xgetbv0() - the XCR0 register, i.e., which register state the OS
+// saves and restores.  The caller must have checked OSXSAVE.
+inline unsigned long long xgetbv0(){
+#if defined(BOOST_RANDOM_DETAIL_CPUID_GNUC)
+    unsigned lo, hi;
+    __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(lo), "=d"(hi) : "c"(0)); // xgetbv
+    return lo | ((unsigned long long)hi << 32);
+#elif defined(BOOST_RANDOM_DETAIL_CPUID_MSVC)
+    return _xgetbv(0);
+#else
+    return 0;
+#endif
+}
+
+inline cpu_feature_flags probe_cpu_features(){
+    cpu_feature_flags f;
+#if defined(BOOST_RANDOM_DETAIL_CPUID_GNUC) || defined(BOOST_RANDOM_DETAIL_CPUID_MSVC)
+    unsigned r1[4], r7[4];
+    cpuid_count(1, 0, r1);
+    cpuid_count(7, 0, r7);
+    f.sse41 = (r1[2] >> 19) & 1;    // leaf 1, ecx
+    f.aes = (r1[2] >> 25) & 1;      // leaf 1, ecx
+    f.sha = (r7[1] >> 29) & 1;      // leaf 7, ebx
+    // The AVX instructions also need the OS to save the ymm registers
+    // (XCR0 bits 1 and 2), and AVX-512 needs the zmm and opmask
+    // registers too (bits 5-7).  vaes is only reported with avx512f,
+    // because we only use its 512-bit forms.
+    bool osxsave = (r1[2] >> 27) & 1;
+    unsigned long long xcr0 = osxsave ? xgetbv0() : 0;
+    bool ymm_state = (xcr0 & 0x6) == 0x6;
+    bool zmm_state = (xcr0 & 0xe6) == 0xe6;
+    f.avx2 = ymm_state && ((r7[1] >> 5) & 1);       // leaf 7, ebx
+    f.avx512f = zmm_state && ((r7[1] >> 16) & 1);   // leaf 7, ebx
+    f.avx512dq = f.avx512f && ((r7[1] >> 17) & 1);  // leaf 7, ebx
+    f.vaes = f.avx512f && ((r7[2] >> 9) & 1);       // leaf 7, ecx
+#else
+    f.sse41 = f.aes = f.sha = f.avx2 = f.avx512f = f.avx512dq = f.vaes = false;
+#if defined(__SSE4_1__)
+    f.sse41 = true;
+#endif
+#if defined(__AES__)
+    f.aes = true;
+#endif
+#if defined(__SHA__)
+    f.sha = true;
+#endif
+#if defined(__AVX2__)
+    f.avx2 = true;
+#endif
+#if defined(__AVX512F__)
+    f.avx512f = true;
+#endif
+#if defined(__AVX512DQ__)
+    f.avx512dq = true;
+#endif
+#if defined(__VAES__) && defined(__AVX512F__)
+    f.vaes = true;
+#endif
+#endif
+    return f;
+}
+
+// simd_level_of(f) - the highest level whose instructions f has.
+inline simd_level simd_level_of(const cpu_feature_flags& f){
+    if( f.sse41 && f.avx2 && f.avx512f && f.avx512dq )
+        return simd_avx512;
+    if( f.sse41 && f.avx2 )
+        return simd_avx2;
+    if( f.sse41 )
+        return simd_sse41;
+    return simd_scalar;
+}
+
+// parse_simd_level(s, l) - set l to the level named by s (see
+// BOOST_RANDOM_SIMD above) and return true, or return false if s
+// doesn't name one.
+inline bool parse_simd_level(const char* s, simd_level& l){
+    if( s == 0 )
+        return false;
+    static const char* const names[] = {"scalar", "sse4.1", "avx2", "avx512"};
+    for(unsigned i=0; i<4; ++i){
+        if( std::strcmp(s, names[i]) == 0 ){
+            l = simd_level(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// cap_cpu_features(f, l) - f without the features above level l.
+inline cpu_feature_flags cap_cpu_features(cpu_feature_flags f, simd_level l){
+    if( l < simd_avx512 )
+        f.avx512f = f.avx512dq = f.vaes = false;
+    if( l < simd_avx2 )
+        f.avx2 = false;
+    if( l < simd_sse41 )
+        f.sse41 = f.aes = f.sha = false;
+    return f;
+}
+
+inline cpu_feature_flags probe_capped_cpu_features(){
+    cpu_feature_flags f = probe_cpu_features();
+    simd_level l;
+    if( parse_simd_level(std::getenv("BOOST_RANDOM_SIMD"), l) )
+        f = cap_cpu_features(f, l);
+    return f;
+}
+
+inline const cpu_feature_flags& cpu_features(){
+    static const cpu_feature_flags f = probe_capped_cpu_features();
+    return f;
+}
+
+// cpu_simd_level() - the highest simd_level the CPU (and
+// BOOST_RANDOM_SIMD) allows.
+inline simd_level cpu_simd_level(){
+    return simd_level_of(cpu_features());
+}
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_CPU_FEATURES_HPP
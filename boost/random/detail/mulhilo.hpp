@@ -12,6 +12,11 @@
 #include <boost/integer.hpp>
 #include <boost/utility/enable_if.hpp>
 #include <boost/static_assert.hpp>
+#include <boost/config.hpp>
+
+#if defined(__BMI2__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 namespace boost{
 namespace random{
@@ -105,22 +110,106 @@ mulhilo(Uint a, Uint b, Uint& hip){
 // quickly and succinctly than a call to mulhilo_halfword.  Without
 // them, philox<N, uintmax_t> would be impractically slow.
 // Unfortunately, they require compiler-and-hardware-specific
-// intrinsics or asm statements.
+// intrinsics, asm statements or types.
+//
+// Each way of doing it is a "policy" with a static apply(a, b, hip)
+// that works like mulhilo.  The ones that the compiler and target
+// support are defined, along with a BOOST_RANDOM_HAVE_MULHILO_XXX
+// macro:
+//
+//   mulhilo_halfword_policy - mulhilo_halfword.  Always available.
+//   mulhilo_int128_policy   - via unsigned __int128 (gcc, clang and
+//                             icc on 64-bit targets).  The compiler
+//                             sees the whole computation, and picks
+//                             the instruction, e.g., mulq or mulx on
+//                             x86-64, umulh on aarch64.
+//   mulhilo_mulq_policy     - x86-64 mulq, in an asm statement.  The
+//                             compiler can't see through it, and mulq
+//                             has fixed registers and clobbers the
+//                             flags.
+//   mulhilo_mulx_policy     - the BMI2 _mulx_u64 intrinsic:  any
+//                             registers and no flags, so the compiler
+//                             can interleave philox4x64's two
+//                             multiplies freely.  Only when compiling
+//                             for a target with BMI2 (-mbmi2 or a
+//                             -march that implies it).
+//
+// mulhilo(uint64_t, uint64_t, uint64_t&) uses mulhilo64_policy, which
+// is BOOST_RANDOM_MULHILO64_POLICY if it's defined, e.g.,
 //
-// FIXME - add more special cases here, e.g., MSVC intrinsics and
-// asm for PowerPC and ARM.
+//   -DBOOST_RANDOM_MULHILO64_POLICY=boost::random::detail::mulhilo_mulq_policy
+//
+// and otherwise the first available of int128, mulx, mulq and
+// halfword.  int128 comes first because the compiler emits mulx for
+// it when the target has BMI2, and mulq when it doesn't, and it can
+// still schedule them freely.  The results are the same, whichever
+// is used;  performance/mulhilo_speed.cpp compares their speed.
+//
+// FIXME - add more special cases here, e.g., MSVC's _umul128.
+struct mulhilo_halfword_policy{
+    template <typename Uint>
+    static BOOST_FORCEINLINE Uint apply(Uint a, Uint b, Uint& hip){
+        return mulhilo_halfword(a, b, hip);
+    }
+};
+
+#if defined(__SIZEOF_INT128__)
+#define BOOST_RANDOM_HAVE_MULHILO_INT128
+struct mulhilo_int128_policy{
+    static BOOST_FORCEINLINE uint64_t apply(uint64_t a, uint64_t b, uint64_t& hip){
+        __extension__ typedef unsigned __int128 uint128_t;
+        uint128_t product = uint128_t(a)*b;
+        hip = uint64_t(product>>64);
+        return uint64_t(product);
+    }
+};
+#endif
+
 #if defined(__GNUC__) && defined(__x86_64__)
+#define BOOST_RANDOM_HAVE_MULHILO_MULQ
+struct mulhilo_mulq_policy{
+    static BOOST_FORCEINLINE uint64_t apply(uint64_t ax, uint64_t b, uint64_t& hip){
+        uint64_t dx;
+        __asm__("\n\t"
+            "mulq %2\n\t"
+            : "=a"(ax), "=d"(dx)
+            : "r"(b), "0"(ax)
+            );
+        hip = dx;
+        return ax;
+    }
+};
+#endif
+
+#if defined(__BMI2__) && defined(__x86_64__)
+#define BOOST_RANDOM_HAVE_MULHILO_MULX
+struct mulhilo_mulx_policy{
+    static BOOST_FORCEINLINE uint64_t apply(uint64_t a, uint64_t b, uint64_t& hip){
+        unsigned long long hi;
+        uint64_t lo = _mulx_u64(a, b, &hi);
+        hip = hi;
+        return lo;
+    }
+};
+#endif
+
+#if defined(BOOST_RANDOM_MULHILO64_POLICY)
+typedef BOOST_RANDOM_MULHILO64_POLICY mulhilo64_policy;
+#elif defined(BOOST_RANDOM_HAVE_MULHILO_INT128)
+typedef mulhilo_int128_policy mulhilo64_policy;
+#elif defined(BOOST_RANDOM_HAVE_MULHILO_MULX)
+typedef mulhilo_mulx_policy mulhilo64_policy;
+#elif defined(BOOST_RANDOM_HAVE_MULHILO_MULQ)
+typedef mulhilo_mulq_policy mulhilo64_policy;
+#else
+typedef mulhilo_halfword_policy mulhilo64_policy;
+#endif
+
+#if !defined(BOOST_NO_INT64_T)
 template <>
 inline uint64_t 
-mulhilo(uint64_t ax, uint64_t b, uint64_t& hip){
-    uint64_t dx;
-    __asm__("\n\t"
-        "mulq %2\n\t"
-        : "=a"(ax), "=d"(dx)
-        : "r"(b), "0"(ax)
-        );
-    hip = dx;
-    return ax;
+mulhilo(uint64_t a, uint64_t b, uint64_t& hip){
+    return mulhilo64_policy::apply(a, b, hip);
 }
 #endif
 
@@ -0,0 +1,161 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_MULHILO_V_HPP
+#define BOOST_RANDOM_DETAIL_MULHILO_V_HPP
+
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/detail/mulhilo.hpp>
+#include <boost/random/detail/simd.hpp>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+namespace detail{
+
+// mulhilo_v - mulhilo on every lane of a vector:
+//
+//   lo = mulhilo_v<Uint>(a, b, hi);
+//
+// sets lo[i] and hi[i] to the low and high words of the double-width
+// product a[i]*b[i], where the lanes are Uints.  It's the building
+// block for multi-lane philox kernels (see philox_simd.hpp).
+//
+// The reference implementation works on a boost::array of any number
+// of lanes of any Uint, one lane at a time, with mulhilo.  The
+// others take SIMD registers, with the lane width given by the
+// explicit template argument.  They're compiled for the instruction
+// sets in simd.hpp, so only call them from a kernel compiled for the
+// same one:
+//
+//   32-bit lanes:  __m128i (SSE4.1), __m256i (AVX2), __m512i (AVX-512).
+//     pmuludq multiplies the even-numbered 32-bit lanes into 64-bit
+//     products, so the odd lanes are shifted down and multiplied
+//     separately, and the halves of the two sets of products are
+//     blended back together.  Two multiplies.
+//
+//   64-bit lanes:  the same three register types.  There's no
+//     64x64->128 bit vector multiply, so it's assembled from the four
+//     32x32->64 bit partial products, as in mulhilo_halfword.  Four
+//     multiplies and about a dozen shifts, masks and adds.  When one
+//     operand is loop-invariant, e.g., a philox multiplier, the
+//     compiler hoists its split into halves out of the loop.
+//     (AVX512-IFMA's 52-bit multiplies would need the operands split
+//     into 52-bit limbs, which costs about as much as it saves.)
+template <typename Uint, std::size_t L>
+inline boost::array<Uint, L>
+mulhilo_v(const boost::array<Uint, L>& a, const boost::array<Uint, L>& b, boost::array<Uint, L>& hip){
+    boost::array<Uint, L> lo;
+    for(std::size_t i=0; i<L; ++i)
+        lo[i] = mulhilo(a[i], b[i], hip[i]);
+    return lo;
+}
+
+#if defined(BOOST_RANDOM_HAVE_SSE41)
+template <typename Uint>
+BOOST_RANDOM_DETAIL_SSE41_TARGET
+__m128i mulhilo_v(__m128i a, __m128i b, __m128i& hip);
+
+template <>
+BOOST_RANDOM_DETAIL_SSE41_TARGET
+inline __m128i mulhilo_v<uint32_t>(__m128i a, __m128i b, __m128i& hip){
+    __m128i pe = _mm_mul_epu32(a, b);
+    __m128i po = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    // 0xcc selects the 16-bit halves of the odd 32-bit lanes.
+    hip = _mm_blend_epi16(_mm_srli_epi64(pe, 32), po, 0xcc);
+    return _mm_blend_epi16(pe, _mm_slli_epi64(po, 32), 0xcc);
+}
+
+template <>
+BOOST_RANDOM_DETAIL_SSE41_TARGET
+inline __m128i mulhilo_v<uint64_t>(__m128i a, __m128i b, __m128i& hip){
+    const __m128i LOMASK = _mm_set1_epi64x(0xffffffff);
+    __m128i ahi = _mm_srli_epi64(a, 32);
+    __m128i bhi = _mm_srli_epi64(b, 32);
+    __m128i ll = _mm_mul_epu32(a, b);
+    __m128i lh = _mm_mul_epu32(a, bhi);
+    __m128i hl = _mm_mul_epu32(ahi, b);
+    __m128i hh = _mm_mul_epu32(ahi, bhi);
+    // mid can't overflow:  it's at most 3*(2^32-1).
+    __m128i mid = _mm_add_epi64(_mm_srli_epi64(ll, 32),
+                                _mm_add_epi64(_mm_and_si128(lh, LOMASK), _mm_and_si128(hl, LOMASK)));
+    hip = _mm_add_epi64(_mm_add_epi64(hh, _mm_srli_epi64(mid, 32)),
+                        _mm_add_epi64(_mm_srli_epi64(lh, 32), _mm_srli_epi64(hl, 32)));
+    return _mm_or_si128(_mm_slli_epi64(mid, 32), _mm_and_si128(ll, LOMASK));
+}
+#endif // BOOST_RANDOM_HAVE_SSE41
+
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+template <typename Uint>
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+__m256i mulhilo_v(__m256i a, __m256i b, __m256i& hip);
+
+template <>
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+inline __m256i mulhilo_v<uint32_t>(__m256i a, __m256i b, __m256i& hip){
+    __m256i pe = _mm256_mul_epu32(a, b);
+    __m256i po = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    hip = _mm256_blend_epi32(_mm256_srli_epi64(pe, 32), po, 0xaa);
+    return _mm256_blend_epi32(pe, _mm256_slli_epi64(po, 32), 0xaa);
+}
+
+template <>
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+inline __m256i mulhilo_v<uint64_t>(__m256i a, __m256i b, __m256i& hip){
+    const __m256i LOMASK = _mm256_set1_epi64x(0xffffffff);
+    __m256i ahi = _mm256_srli_epi64(a, 32);
+    __m256i bhi = _mm256_srli_epi64(b, 32);
+    __m256i ll = _mm256_mul_epu32(a, b);
+    __m256i lh = _mm256_mul_epu32(a, bhi);
+    __m256i hl = _mm256_mul_epu32(ahi, b);
+    __m256i hh = _mm256_mul_epu32(ahi, bhi);
+    __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(ll, 32),
+                                   _mm256_add_epi64(_mm256_and_si256(lh, LOMASK), _mm256_and_si256(hl, LOMASK)));
+    hip = _mm256_add_epi64(_mm256_add_epi64(hh, _mm256_srli_epi64(mid, 32)),
+                           _mm256_add_epi64(_mm256_srli_epi64(lh, 32), _mm256_srli_epi64(hl, 32)));
+    return _mm256_or_si256(_mm256_slli_epi64(mid, 32), _mm256_and_si256(ll, LOMASK));
+}
+#endif // BOOST_RANDOM_HAVE_AVX2
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+template <typename Uint>
+BOOST_RANDOM_DETAIL_AVX512_TARGET
+__m512i mulhilo_v(__m512i a, __m512i b, __m512i& hip);
+
+template <>
+BOOST_RANDOM_DETAIL_AVX512_TARGET
+inline __m512i mulhilo_v<uint32_t>(__m512i a, __m512i b, __m512i& hip){
+    __m512i pe = _mm512_mul_epu32(a, b);
+    __m512i po = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+    hip = _mm512_mask_blend_epi32(0xaaaa, _mm512_srli_epi64(pe, 32), po);
+    return _mm512_mask_blend_epi32(0xaaaa, pe, _mm512_slli_epi64(po, 32));
+}
+
+template <>
+BOOST_RANDOM_DETAIL_AVX512_TARGET
+inline __m512i mulhilo_v<uint64_t>(__m512i a, __m512i b, __m512i& hip){
+    const __m512i LOMASK = _mm512_set1_epi64(0xffffffff);
+    __m512i ahi = _mm512_srli_epi64(a, 32);
+    __m512i bhi = _mm512_srli_epi64(b, 32);
+    __m512i ll = _mm512_mul_epu32(a, b);
+    __m512i lh = _mm512_mul_epu32(a, bhi);
+    __m512i hl = _mm512_mul_epu32(ahi, b);
+    __m512i hh = _mm512_mul_epu32(ahi, bhi);
+    __m512i mid = _mm512_add_epi64(_mm512_srli_epi64(ll, 32),
+                                   _mm512_add_epi64(_mm512_and_si512(lh, LOMASK), _mm512_and_si512(hl, LOMASK)));
+    hip = _mm512_add_epi64(_mm512_add_epi64(hh, _mm512_srli_epi64(mid, 32)),
+                           _mm512_add_epi64(_mm512_srli_epi64(lh, 32), _mm512_srli_epi64(hl, 32)));
+    return _mm512_or_si512(_mm512_slli_epi64(mid, 32), _mm512_and_si512(ll, LOMASK));
+}
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif // BOOST_RANDOM_HAVE_AVX512
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_MULHILO_V_HPP
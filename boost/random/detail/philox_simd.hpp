@@ -0,0 +1,364 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_PHILOX_SIMD_HPP
+#define BOOST_RANDOM_DETAIL_PHILOX_SIMD_HPP
+
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/detail/simd.hpp>
+#include <boost/random/detail/simd_dispatch.hpp>
+#include <boost/random/detail/mulhilo_v.hpp>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+
+// The self-tests check the kernels against philox itself.
+template <unsigned N, typename Uint, unsigned R, typename Constants, bool CacheKeySchedule>
+struct philox;
+
+namespace detail{
+
+// philox_simd - multi-lane kernels that evaluate philox on several
+// independent counters at once, all with the same key.  Each
+// specialization provides:
+//
+//   static std::size_t apply(const key_type& k, const domain_type* in,
+//                            range_type* out, std::size_t n);
+//
+// which computes out[i] = philox(k)(in[i]) for i in [0, m), where m
+// is the largest multiple of the kernel's lane count that is <= n,
+// and returns m.  The caller (philox's batch operator()) is
+// responsible for the leftover n-m counters.  The results must be
+// bit-identical to the scalar philox.
+//
+// apply calls the best kernel for the CPU, chosen the first time it's
+// called (see simd_dispatch.hpp), from the ones below:
+//
+//   philox4x32:  SSE4.1 (4 lanes) and AVX2 (8 lanes).
+//   philox2x64 and philox4x64:  AVX-512 (8 lanes).
+//
+// kernel(l) returns the kernel for level l, or 0 if there isn't one.
+// The primary template has no kernels at all, and apply does nothing.
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+struct philox_simd{
+    template <typename KeyType, typename DomainType, typename RangeType>
+    static std::size_t apply(const KeyType&, const DomainType*, RangeType*, std::size_t){
+        return 0;
+    }
+};
+
+#if defined(BOOST_RANDOM_HAVE_SSE41)
+namespace sse41{
+// philox4x32 with SSE4.1:  each __m128i holds the same word of four
+// different counters (see soa_load in simd.hpp), and the multiplies
+// are mulhilo_v<uint32_t> (see mulhilo_v.hpp).
+template <unsigned R, typename Constants>
+struct philox4x32_kernel{
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 4);
+    typedef boost::array<uint32_t, 4> domain_type;
+    typedef boost::array<uint32_t, 4> range_type;
+    typedef boost::array<uint32_t, 2> key_type;
+
+    BOOST_RANDOM_DETAIL_SSE41_TARGET
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        std::size_t i = 0;
+        for( ; i+2*lanes<=m; i+=2*lanes)
+            apply4<2>(k, in+i, out+i);
+        if( i<m )
+            apply4<1>(k, in+i, out+i);
+        return m;
+    }
+
+protected:
+    // As in the AVX2 kernel below, G independent groups hide the
+    // multiplies' latency.
+    template <unsigned G>
+    BOOST_RANDOM_DETAIL_SSE41_TARGET
+    static inline void apply4(const key_type& k, const domain_type* in, range_type* out){
+        __m128i c[G][4];
+        for(unsigned g=0; g<G; ++g)
+            soa_load(in[4*g].data(), c[g]);
+
+        const __m128i M0 = _mm_set1_epi32(Constants::M0);
+        const __m128i M1 = _mm_set1_epi32(Constants::M1);
+        const __m128i W0 = _mm_set1_epi32(Constants::W0);
+        const __m128i W1 = _mm_set1_epi32(Constants::W1);
+        __m128i k0 = _mm_set1_epi32(k[0]);
+        __m128i k1 = _mm_set1_epi32(k[1]);
+        for(unsigned r=0; r<R; ++r){
+            for(unsigned g=0; g<G; ++g){
+                __m128i hi0, hi1;
+                __m128i lo0 = mulhilo_v<uint32_t>(M0, c[g][0], hi0);
+                __m128i lo1 = mulhilo_v<uint32_t>(M1, c[g][2], hi1);
+                c[g][0] = _mm_xor_si128(_mm_xor_si128(hi1, c[g][1]), k0);
+                c[g][1] = lo1;
+                c[g][2] = _mm_xor_si128(_mm_xor_si128(hi0, c[g][3]), k1);
+                c[g][3] = lo0;
+            }
+            k0 = _mm_add_epi32(k0, W0);
+            k1 = _mm_add_epi32(k1, W1);
+        }
+
+        for(unsigned g=0; g<G; ++g)
+            soa_store(out[4*g].data(), c[g]);
+    }
+};
+} // namespace sse41
+#endif // BOOST_RANDOM_HAVE_SSE41
+
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+namespace avx2{
+// philox4x32 with AVX2:  the same, eight counters at a time.
+template <unsigned R, typename Constants>
+struct philox4x32_kernel{
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 8);
+    typedef boost::array<uint32_t, 4> domain_type;
+    typedef boost::array<uint32_t, 4> range_type;
+    typedef boost::array<uint32_t, 2> key_type;
+
+    BOOST_RANDOM_DETAIL_AVX2_TARGET
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        std::size_t i = 0;
+        for( ; i+2*lanes<=m; i+=2*lanes)
+            apply8<2>(k, in+i, out+i);
+        if( i<m )
+            apply8<1>(k, in+i, out+i);
+        return m;
+    }
+
+protected:
+    // apply8 evaluates G independent groups of eight counters.  A
+    // single group is one long dependency chain through the
+    // multiplies, so the pipelines would be mostly idle.  With G=2
+    // the two chains are interleaved and the latency is hidden.
+    template <unsigned G>
+    BOOST_RANDOM_DETAIL_AVX2_TARGET
+    static inline void apply8(const key_type& k, const domain_type* in, range_type* out){
+        __m256i c[G][4];
+        for(unsigned g=0; g<G; ++g)
+            soa_load(in[8*g].data(), c[g]);
+
+        const __m256i M0 = _mm256_set1_epi32(Constants::M0);
+        const __m256i M1 = _mm256_set1_epi32(Constants::M1);
+        const __m256i W0 = _mm256_set1_epi32(Constants::W0);
+        const __m256i W1 = _mm256_set1_epi32(Constants::W1);
+        __m256i k0 = _mm256_set1_epi32(k[0]);
+        __m256i k1 = _mm256_set1_epi32(k[1]);
+        for(unsigned r=0; r<R; ++r){
+            for(unsigned g=0; g<G; ++g){
+                __m256i hi0, hi1;
+                __m256i lo0 = mulhilo_v<uint32_t>(M0, c[g][0], hi0);
+                __m256i lo1 = mulhilo_v<uint32_t>(M1, c[g][2], hi1);
+                c[g][0] = _mm256_xor_si256(_mm256_xor_si256(hi1, c[g][1]), k0);
+                c[g][1] = lo1;
+                c[g][2] = _mm256_xor_si256(_mm256_xor_si256(hi0, c[g][3]), k1);
+                c[g][3] = lo0;
+            }
+            k0 = _mm256_add_epi32(k0, W0);
+            k1 = _mm256_add_epi32(k1, W1);
+        }
+
+        for(unsigned g=0; g<G; ++g)
+            soa_store(out[8*g].data(), c[g]);
+    }
+};
+} // namespace avx2
+#endif // BOOST_RANDOM_HAVE_AVX2
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+namespace avx512{
+// The 64-bit philoxes with AVX-512.  There is no 64x64->128 bit
+// vector multiply, so mulhilo_v<uint64_t> assembles one from four
+// 32x32->64 bit partial products.
+// philox2x64 with AVX-512.
+template <unsigned R, typename Constants>
+struct philox2x64_kernel{
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 8);
+    typedef boost::array<uint64_t, 2> domain_type;
+    typedef boost::array<uint64_t, 2> range_type;
+    typedef boost::array<uint64_t, 1> key_type;
+
+    BOOST_RANDOM_DETAIL_AVX512_TARGET
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        std::size_t i = 0;
+        for( ; i+2*lanes<=m; i+=2*lanes)
+            apply8<2>(k, in+i, out+i);
+        if( i<m )
+            apply8<1>(k, in+i, out+i);
+        return m;
+    }
+
+protected:
+    template <unsigned G>
+    BOOST_RANDOM_DETAIL_AVX512_TARGET
+    static inline void apply8(const key_type& k, const domain_type* in, range_type* out){
+        __m512i c[G][2];
+        for(unsigned g=0; g<G; ++g)
+            soa_load(in[8*g].data(), c[g]);
+
+        const __m512i M0 = _mm512_set1_epi64(Constants::M0);
+        const __m512i W0 = _mm512_set1_epi64(Constants::W0);
+        __m512i k0 = _mm512_set1_epi64(k[0]);
+        for(unsigned r=0; r<R; ++r){
+            for(unsigned g=0; g<G; ++g){
+                __m512i hi0;
+                __m512i lo0 = mulhilo_v<uint64_t>(M0, c[g][0], hi0);
+                c[g][0] = _mm512_xor_si512(_mm512_xor_si512(hi0, k0), c[g][1]);
+                c[g][1] = lo0;
+            }
+            k0 = _mm512_add_epi64(k0, W0);
+        }
+
+        for(unsigned g=0; g<G; ++g)
+            soa_store(out[8*g].data(), c[g]);
+    }
+};
+
+// philox4x64 with AVX-512.
+template <unsigned R, typename Constants>
+struct philox4x64_kernel{
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 8);
+    typedef boost::array<uint64_t, 4> domain_type;
+    typedef boost::array<uint64_t, 4> range_type;
+    typedef boost::array<uint64_t, 2> key_type;
+
+    BOOST_RANDOM_DETAIL_AVX512_TARGET
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        std::size_t i = 0;
+        for( ; i+2*lanes<=m; i+=2*lanes)
+            apply8<2>(k, in+i, out+i);
+        if( i<m )
+            apply8<1>(k, in+i, out+i);
+        return m;
+    }
+
+protected:
+    template <unsigned G>
+    BOOST_RANDOM_DETAIL_AVX512_TARGET
+    static inline void apply8(const key_type& k, const domain_type* in, range_type* out){
+        __m512i c[G][4];
+        for(unsigned g=0; g<G; ++g)
+            soa_load(in[8*g].data(), c[g]);
+
+        const __m512i M0 = _mm512_set1_epi64(Constants::M0);
+        const __m512i M1 = _mm512_set1_epi64(Constants::M1);
+        const __m512i W0 = _mm512_set1_epi64(Constants::W0);
+        const __m512i W1 = _mm512_set1_epi64(Constants::W1);
+        __m512i k0 = _mm512_set1_epi64(k[0]);
+        __m512i k1 = _mm512_set1_epi64(k[1]);
+        for(unsigned r=0; r<R; ++r){
+            for(unsigned g=0; g<G; ++g){
+                __m512i hi0, hi1;
+                __m512i lo0 = mulhilo_v<uint64_t>(M0, c[g][0], hi0);
+                __m512i lo1 = mulhilo_v<uint64_t>(M1, c[g][2], hi1);
+                c[g][0] = _mm512_xor_si512(_mm512_xor_si512(hi1, c[g][1]), k0);
+                c[g][1] = lo1;
+                c[g][2] = _mm512_xor_si512(_mm512_xor_si512(hi0, c[g][3]), k1);
+                c[g][3] = lo0;
+            }
+            k0 = _mm512_add_epi64(k0, W0);
+            k1 = _mm512_add_epi64(k1, W1);
+        }
+
+        for(unsigned g=0; g<G; ++g)
+            soa_store(out[8*g].data(), c[g]);
+    }
+};
+} // namespace avx512
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif // BOOST_RANDOM_HAVE_AVX512
+
+// The dispatchers.
+#if defined(BOOST_RANDOM_HAVE_SSE41) || defined(BOOST_RANDOM_HAVE_AVX2)
+template <unsigned R, typename Constants>
+struct philox_simd<4, uint32_t, R, Constants>{
+    typedef boost::array<uint32_t, 4> domain_type;
+    typedef boost::array<uint32_t, 4> range_type;
+    typedef boost::array<uint32_t, 2> key_type;
+    typedef std::size_t (*kernel_type)(const key_type&, const domain_type*, range_type*, std::size_t);
+
+    static kernel_type kernel(simd_level l){
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+        if( l == simd_avx2 )
+            return &avx2::philox4x32_kernel<R, Constants>::apply;
+#endif
+#if defined(BOOST_RANDOM_HAVE_SSE41)
+        if( l == simd_sse41 )
+            return &sse41::philox4x32_kernel<R, Constants>::apply;
+#endif
+        (void)l;
+        return 0;
+    }
+
+    static kernel_type selected(){
+        static const kernel_type k = select_kernel<philox_simd>(prf_kernel_test<philox<4, uint32_t, R, Constants, false> >());
+        return k;
+    }
+
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        kernel_type kern = selected();
+        return kern ? kern(k, in, out, n) : 0;
+    }
+};
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+template <unsigned R, typename Constants>
+struct philox_simd<2, uint64_t, R, Constants>{
+    typedef boost::array<uint64_t, 2> domain_type;
+    typedef boost::array<uint64_t, 2> range_type;
+    typedef boost::array<uint64_t, 1> key_type;
+    typedef std::size_t (*kernel_type)(const key_type&, const domain_type*, range_type*, std::size_t);
+
+    static kernel_type kernel(simd_level l){
+        return l == simd_avx512 ? &avx512::philox2x64_kernel<R, Constants>::apply : 0;
+    }
+
+    static kernel_type selected(){
+        static const kernel_type k = select_kernel<philox_simd>(prf_kernel_test<philox<2, uint64_t, R, Constants, false> >());
+        return k;
+    }
+
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        kernel_type kern = selected();
+        return kern ? kern(k, in, out, n) : 0;
+    }
+};
+
+template <unsigned R, typename Constants>
+struct philox_simd<4, uint64_t, R, Constants>{
+    typedef boost::array<uint64_t, 4> domain_type;
+    typedef boost::array<uint64_t, 4> range_type;
+    typedef boost::array<uint64_t, 2> key_type;
+    typedef std::size_t (*kernel_type)(const key_type&, const domain_type*, range_type*, std::size_t);
+
+    static kernel_type kernel(simd_level l){
+        return l == simd_avx512 ? &avx512::philox4x64_kernel<R, Constants>::apply : 0;
+    }
+
+    static kernel_type selected(){
+        static const kernel_type k = select_kernel<philox_simd>(prf_kernel_test<philox<4, uint64_t, R, Constants, false> >());
+        return k;
+    }
+
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        kernel_type kern = selected();
+        return kern ? kern(k, in, out, n) : 0;
+    }
+};
+#endif // BOOST_RANDOM_HAVE_AVX512
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_PHILOX_SIMD_HPP
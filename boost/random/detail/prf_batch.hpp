@@ -0,0 +1,79 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_PRF_BATCH_HPP
+#define BOOST_RANDOM_DETAIL_PRF_BATCH_HPP
+
+#include <boost/utility/enable_if.hpp>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+namespace detail{
+
+// Batch evaluation - an optional extension of the
+// "PseudoRandomFunction" concept.  In addition to
+//
+//    range_type operator()(domain_type c) const;
+//
+// a Prf may provide
+//
+//    void operator()(const domain_type* in, range_type* out, std::size_t n) const;
+//
+// which must assign (*this)(in[i]) to out[i] for every i in [0, n).
+// It's an opportunity to amortize per-call setup (e.g., a key
+// schedule) over many counters, or to evaluate several counters at
+// once with SIMD instructions.  The results must be bit-identical to
+// the one-at-a-time operator().
+//
+// has_batch_operator<Prf>::value tells whether Prf provides the batch
+// operator(), and prf_batch(prf, in, out, n) calls it if so, or loops
+// over the one-at-a-time operator() if not.  Bulk consumers, e.g.,
+// counter_based_engine::fill, should call prf_batch rather than
+// calling the batch operator() directly.
+//
+// The member detector is the same trick as class_has_elems in
+// counter_traits.hpp.  It finds the batch operator() only if it's a
+// non-template, const member with exactly the signature above - like
+// the one-at-a-time operator(), it mustn't change the Prf, and
+// prf_batch calls it through a const Prf&.  Prfs that can't or don't
+// want to meet that requirement can specialize has_batch_operator
+// instead.
+template <typename Prf>
+struct has_batch_operator{
+private:
+    typedef typename Prf::domain_type domain_type;
+    typedef typename Prf::range_type range_type;
+    typedef void (Prf::*batch_type)(const domain_type*, range_type*, std::size_t) const;
+    template <typename U, U> struct Check;
+    typedef char ArrayOfOne[1];
+    typedef char ArrayOfTwo[2];
+    template <typename U>
+    static ArrayOfOne& func(Check<batch_type, &U::operator()> *);
+    template <typename U>
+    static ArrayOfTwo& func(...);
+
+public:
+    static const bool value = sizeof( func<Prf>(0) ) == 1;
+};
+
+template <typename Prf>
+inline typename boost::enable_if_c<has_batch_operator<Prf>::value>::type
+prf_batch(const Prf& prf, const typename Prf::domain_type* in, typename Prf::range_type* out, std::size_t n){
+    prf(in, out, n);
+}
+
+template <typename Prf>
+inline typename boost::enable_if_c<!has_batch_operator<Prf>::value>::type
+prf_batch(const Prf& prf, const typename Prf::domain_type* in, typename Prf::range_type* out, std::size_t n){
+    for(std::size_t i=0; i<n; ++i)
+        out[i] = prf(in[i]);
+}
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_PRF_BATCH_HPP
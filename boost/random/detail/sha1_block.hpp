@@ -0,0 +1,299 @@
+// Copyright 2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_SHA1_BLOCK_HPP
+#define BOOST_RANDOM_DETAIL_SHA1_BLOCK_HPP
+
+// The SHA-1 compression function, for sha1_prf.  sha1_prf's messages
+// are short enough to fit in a single 64-byte block, so rather than
+// streaming bytes through uuids::detail::sha1, it builds the padded
+// block itself, as sixteen big-endian words, and calls
+//
+//    sha1_compress(h, w);
+//
+// once, which updates the five-word state h with the block w.
+//
+// sha1_compress uses the Intel SHA extensions (sha1rnds4 and
+// friends) if the CPU has them, and a portable implementation if it
+// doesn't.  The SHA-NI kernel is compiled whether or not the compiler
+// was told the target has the extensions (with gcc's and clang's
+// target attribute), and cpu_features() decides at runtime whether
+// to call it.  Define BOOST_RANDOM_NO_SHA1_SHANI to leave it out
+// altogether.
+
+#include <boost/config.hpp>
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/detail/cpu_features.hpp>
+#include <boost/random/detail/unroll.hpp>
+#include <cstddef>
+
+#if !defined(BOOST_RANDOM_NO_SHA1_SHANI)
+#if defined(BOOST_RANDOM_DETAIL_CPUID_GNUC) && (defined(__clang__) || __GNUC__ >= 5)
+#include <immintrin.h>
+#define BOOST_RANDOM_HAVE_SHA1_SHANI
+#define BOOST_RANDOM_DETAIL_SHA1_SHANI_TARGET __attribute__((target("sha,sse4.1")))
+#elif defined(BOOST_RANDOM_DETAIL_CPUID_MSVC) && _MSC_VER >= 1900
+#include <immintrin.h>
+#define BOOST_RANDOM_HAVE_SHA1_SHANI
+#define BOOST_RANDOM_DETAIL_SHA1_SHANI_TARGET
+#endif
+#endif
+
+namespace boost{
+namespace random{
+namespace detail{
+
+inline uint32_t sha1_rotl(uint32_t x, unsigned s){
+    return (x<<s) | (x>>(32-s));
+}
+
+// sha1_block_words<Version> - the padded single-block message that
+// sha1_prf<Ndomain, Nkey, Version> hashes for key k and counter c, as
+// sixteen big-endian words (see sha1_prf.hpp).  Only for Nwords =
+// Nkey+Ndomain <= 13.
+//
+// Version 1:  the byte Nkey, then the key and counter words.  The
+//   leading byte shifts every word one byte to the right of the
+//   block's word boundaries.
+// Version 2:  the key and counter words, then the byte Nkey.  The
+//   first Nkey words of the block are the key, so the first Nkey
+//   rounds of the compression function don't depend on the counter.
+template <unsigned Version, std::size_t Ndomain, std::size_t Nkey>
+inline void sha1_block_words(const boost::array<uint32_t, Nkey>& k, const boost::array<uint32_t, Ndomain>& c,
+                             uint32_t (&w)[16]){
+    const unsigned Nwords = unsigned(Nkey+Ndomain);
+    if( Version == 1 ){
+        uint32_t carry = uint32_t(Nkey);
+        for(unsigned i=0; i<Nwords; ++i){
+            uint32_t x = i<Nkey ? k[i] : c[i-Nkey];
+            w[i] = (carry<<24) | (x>>8);
+            carry = x & 0xff;
+        }
+        w[Nwords] = (carry<<24) | 0x800000;
+    }else{
+        for(unsigned i=0; i<Nwords; ++i)
+            w[i] = i<Nkey ? k[i] : c[i-Nkey];
+        w[Nwords] = (uint32_t(Nkey)<<24) | 0x800000;
+    }
+    for(unsigned i=Nwords+1; i<15; ++i)
+        w[i] = 0;
+    w[15] = 8*(1+4*Nwords);
+}
+
+// sha1_init - set h to the initial hash value, H(0).
+inline void sha1_init(uint32_t (&h)[5]){
+    h[0] = 0x67452301;
+    h[1] = 0xefcdab89;
+    h[2] = 0x98badcfe;
+    h[3] = 0x10325476;
+    h[4] = 0xc3d2e1f0;
+}
+
+// sha1_rounds_v, the rounds on every lane of a vector, or on a
+// uint32_t with sha1_scalar_ops.  See sha1_rounds.ipp.
+#define BOOST_RANDOM_DETAIL_SIMD_TARGET
+#include <boost/random/detail/sha1_rounds.ipp>
+#undef BOOST_RANDOM_DETAIL_SIMD_TARGET
+
+struct sha1_scalar_ops{
+    typedef uint32_t type;
+    static uint32_t set1(uint32_t x){ return x; }
+    static uint32_t add(uint32_t a, uint32_t b){ return a + b; }
+    static uint32_t xor_(uint32_t a, uint32_t b){ return a ^ b; }
+    static uint32_t rotl(uint32_t x, unsigned s){ return sha1_rotl(x, s); }
+    static uint32_t ch(uint32_t b, uint32_t c, uint32_t d){ return d ^ (b & (c ^ d)); }
+    static uint32_t parity(uint32_t b, uint32_t c, uint32_t d){ return b ^ c ^ d; }
+    static uint32_t maj(uint32_t b, uint32_t c, uint32_t d){ return (b & c) | (d & (b | c)); }
+};
+
+// sha1_rounds<T0, T1>(s, w) - rounds T0 through T1-1 on one block.
+// s holds the working variables after round T0-1 (or the hash value,
+// if T0 is 0).  w holds the block, and for T0 > 16 it must hold
+// words T0-16..T0-1 of the schedule instead.  Both are updated in
+// place.
+template <unsigned T0, unsigned T1>
+inline void sha1_rounds(uint32_t (&s)[5], uint32_t (&w)[16]){
+    sha1_rounds_v<sha1_scalar_ops> r;
+    r.a = s[0];
+    r.b = s[1];
+    r.c = s[2];
+    r.d = s[3];
+    r.e = s[4];
+    for(unsigned t=0; t<16; ++t)
+        r.w[t] = w[t];
+    unroll<T1, T0>::apply(r);
+    s[0] = r.a;
+    s[1] = r.b;
+    s[2] = r.c;
+    s[3] = r.d;
+    s[4] = r.e;
+    for(unsigned t=0; t<16; ++t)
+        w[t] = r.w[t];
+}
+
+// sha1_compress_portable - the whole compression function.
+inline void sha1_compress_portable(uint32_t (&h)[5], const uint32_t (&block)[16]){
+    uint32_t w[16];
+    for(unsigned t=0; t<16; ++t)
+        w[t] = block[t];
+    uint32_t s[5] = {h[0], h[1], h[2], h[3], h[4]};
+    sha1_rounds<0, 80>(s, w);
+    for(unsigned i=0; i<5; ++i)
+        h[i] += s[i];
+}
+
+// sha1_prf_midstate<Version> - what sha1_prf caches when its key is
+// set.  For Version 1, nothing, so it's an empty base.  For Version
+// 2, the working state after the first Nkey rounds, which depend only
+// on the key.  start(s) sets s to the state the counter-dependent
+// rounds start from.
+template <unsigned Version>
+struct sha1_prf_midstate{
+    template <typename KeyType>
+    void setkey(const KeyType&){}
+    void start(uint32_t (&s)[5]) const{
+        sha1_init(s);
+    }
+};
+
+template <>
+struct sha1_prf_midstate<2>{
+    template <typename KeyType>
+    void setkey(const KeyType& k){
+        // Only the first k.size() words matter, but sha1_rounds
+        // copies all 16.
+        uint32_t w[16] = {0};
+        for(unsigned i=0; i<k.size(); ++i)
+            w[i] = k[i];
+        sha1_init(mid);
+        sha1_rounds<0, KeyType::static_size>(mid, w);
+    }
+    void start(uint32_t (&s)[5]) const{
+        for(unsigned i=0; i<5; ++i)
+            s[i] = mid[i];
+    }
+protected:
+    uint32_t mid[5];
+};
+
+#if defined(BOOST_RANDOM_HAVE_SHA1_SHANI)
+// sha1_compress_shani - after Intel's reference code for the SHA
+// extensions.  Each sha1rnds4 does four rounds.  The message
+// schedule for rounds 16-79 is four words at a time, in msg0..msg3,
+// with sha1msg1, xor and sha1msg2, overlapped with the rounds that
+// use the previous four words.  The words are loaded from w rather
+// than byte-swapped from the message bytes, so the only shuffle
+// puts them in the descending order the instructions expect.
+BOOST_RANDOM_DETAIL_SHA1_SHANI_TARGET
+inline void sha1_compress_shani(uint32_t (&h)[5], const uint32_t (&w)[16]){
+    // The SHA instructions only have legacy SSE encodings.  If the
+    // caller was compiled for AVX, the upper halves of the vector
+    // registers may be dirty, and mixing the two without a vzeroupper
+    // is ruinously slow on some CPUs (100x, here).
+#if defined(__AVX__)
+    _mm256_zeroupper();
+#endif
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h)), 0x1b);
+    __m128i e0 = _mm_set_epi32(h[4], 0, 0, 0);
+    const __m128i abcd_save = abcd;
+    const __m128i e0_save = e0;
+    __m128i e1;
+    __m128i msg0 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w)), 0x1b);
+    __m128i msg1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w+4)), 0x1b);
+    __m128i msg2 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w+8)), 0x1b);
+    __m128i msg3 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w+12)), 0x1b);
+
+    // Rounds 0-3
+    e0 = _mm_add_epi32(e0, msg0);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    // Rounds 4-7
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+    // Rounds 8-11
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 12-67 all look the same, with the roles of msg0..msg3
+    // and of e0 and e1 rotating.
+#define BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(ecur, enext, mcur, mnext, mprev, mprev2, f) \
+    ecur = _mm_sha1nexte_epu32(ecur, mcur);                             \
+    enext = abcd;                                                       \
+    mnext = _mm_sha1msg2_epu32(mnext, mcur);                            \
+    abcd = _mm_sha1rnds4_epu32(abcd, ecur, f);                          \
+    mprev = _mm_sha1msg1_epu32(mprev, mcur);                            \
+    mprev2 = _mm_xor_si128(mprev2, mcur)
+
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e1, e0, msg3, msg0, msg2, msg1, 0); // 12-15
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e0, e1, msg0, msg1, msg3, msg2, 0); // 16-19
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e1, e0, msg1, msg2, msg0, msg3, 1); // 20-23
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e0, e1, msg2, msg3, msg1, msg0, 1); // 24-27
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e1, e0, msg3, msg0, msg2, msg1, 1); // 28-31
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e0, e1, msg0, msg1, msg3, msg2, 1); // 32-35
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e1, e0, msg1, msg2, msg0, msg3, 1); // 36-39
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e0, e1, msg2, msg3, msg1, msg0, 2); // 40-43
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e1, e0, msg3, msg0, msg2, msg1, 2); // 44-47
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e0, e1, msg0, msg1, msg3, msg2, 2); // 48-51
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e1, e0, msg1, msg2, msg0, msg3, 2); // 52-55
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e0, e1, msg2, msg3, msg1, msg0, 2); // 56-59
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e1, e0, msg3, msg0, msg2, msg1, 3); // 60-63
+    BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS(e0, e1, msg0, msg1, msg3, msg2, 3); // 64-67
+#undef BOOST_RANDOM_DETAIL_SHA1_SHANI_ROUNDS
+
+    // Rounds 68-71
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+    msg3 = _mm_xor_si128(msg3, msg1);
+    // Rounds 72-75
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+    // Rounds 76-79
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+    e0 = _mm_sha1nexte_epu32(e0, e0_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(h), _mm_shuffle_epi32(abcd, 0x1b));
+    h[4] = _mm_extract_epi32(e0, 3);
+}
+#endif // BOOST_RANDOM_HAVE_SHA1_SHANI
+
+// sha1_has_shani() - whether sha1_compress will use the SHA-NI
+// kernel.
+inline bool sha1_has_shani(){
+#if defined(BOOST_RANDOM_HAVE_SHA1_SHANI)
+    return cpu_features().sha && cpu_features().sse41;
+#else
+    return false;
+#endif
+}
+
+inline void sha1_compress(uint32_t (&h)[5], const uint32_t (&w)[16]){
+#if defined(BOOST_RANDOM_HAVE_SHA1_SHANI)
+    static const bool shani = sha1_has_shani();
+    if( shani ){
+        sha1_compress_shani(h, w);
+        return;
+    }
+#endif
+    sha1_compress_portable(h, w);
+}
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_SHA1_BLOCK_HPP
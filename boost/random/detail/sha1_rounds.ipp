@@ -0,0 +1,41 @@
+// Copyright 2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// No include guard:  sha1_block.hpp includes this in namespace detail
+// for the scalar code, and sha1_simd.hpp includes it again in each of
+// its instruction sets' namespaces (see simd.hpp), with
+// BOOST_RANDOM_DETAIL_SIMD_TARGET defined as the target attribute.
+
+// sha1_rounds_v - the rounds of the compression function (FIPS
+// 180-4, section 6.1.2) on every lane of a vector of 32-bit lanes,
+// with V one of the vec32 structs in simd.hpp, or sha1_scalar_ops (in
+// sha1_block.hpp), for one lane in a plain uint32_t.  a..e are the
+// working variables and w[t] is message word t, with the schedule for
+// rounds 16-79 overwriting it in place.  unroll<T1, T0>::apply does
+// rounds T0 through T1-1, with the round number a compile-time
+// constant in each.
+template <typename V>
+struct sha1_rounds_v{
+    typedef typename V::type vec;
+    vec a, b, c, d, e;
+    vec w[16];
+
+    template <unsigned t>
+    BOOST_RANDOM_DETAIL_SIMD_TARGET BOOST_FORCEINLINE void round(){
+        if( t >= 16 )
+            w[t&15] = V::rotl(V::xor_(V::xor_(w[(t+13)&15], w[(t+8)&15]), V::xor_(w[(t+2)&15], w[t&15])), 1);
+        vec f = t<20 ? V::ch(b, c, d) :
+                t<40 ? V::parity(b, c, d) :
+                t<60 ? V::maj(b, c, d) :
+                V::parity(b, c, d);
+        const uint32_t K = t<20 ? 0x5a827999 : t<40 ? 0x6ed9eba1 : t<60 ? 0x8f1bbcdc : 0xca62c1d6;
+        vec tmp = V::add(V::add(V::rotl(a, 5), f), V::add(V::add(e, V::set1(K)), w[t&15]));
+        e = d;
+        d = c;
+        c = V::rotl(b, 30);
+        b = a;
+        a = tmp;
+    }
+};
@@ -0,0 +1,142 @@
+// Copyright 2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_SHA1_SIMD_HPP
+#define BOOST_RANDOM_DETAIL_SHA1_SIMD_HPP
+
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/detail/simd.hpp>
+#include <boost/random/detail/simd_dispatch.hpp>
+#include <boost/random/detail/sha1_block.hpp>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+
+// The self-test checks the kernels against sha1_prf itself.
+template <unsigned Ndomain, unsigned Nkey, unsigned Version>
+class sha1_prf;
+
+namespace detail{
+
+// sha1_simd - multi-buffer SHA-1 for sha1_prf's batch operator(),
+// with one counter per lane.  The interface is like philox_simd's,
+// with an extra argument for sha1_prf<Ndomain, Nkey, 2>'s cached
+// midstate:
+//
+//   static std::size_t apply(const key_type& k, const uint32_t (&s0)[5],
+//                            const domain_type* in, range_type* out, std::size_t n);
+//
+// computes out[i] = sha1_prf(k)(in[i]) for i in [0, m), where m is
+// the largest multiple of the kernel's lane count that is <= n, and
+// returns m.  s0 is the working state after the first T0 rounds,
+// which don't depend on the counter:  T0 is Nkey for Version 2, and
+// 0, i.e., s0 is H(0), for Version 1.
+//
+// Each group of counters' padded blocks are built with scalar code
+// and transposed into a word-major buffer, so that w[t] is one vector
+// load, and the digests are transposed back the same way.  That's
+// cheap next to 80 rounds.  Only the single-block shapes
+// (SingleBlock) have kernels, for AVX2 (8 lanes) and AVX-512 (16
+// lanes), both from sha1_simd.ipp, and apply uses the best one the
+// CPU has (see simd_dispatch.hpp).  Otherwise, apply does nothing.
+template <unsigned Ndomain, unsigned Nkey, unsigned Version, bool SingleBlock>
+struct sha1_simd{
+    template <typename KeyType, typename DomainType, typename RangeType>
+    static std::size_t apply(const KeyType&, const uint32_t (&)[5], const DomainType*, RangeType*, std::size_t){
+        return 0;
+    }
+};
+
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+namespace avx2{
+#define BOOST_RANDOM_DETAIL_SIMD_TARGET BOOST_RANDOM_DETAIL_AVX2_TARGET
+#include <boost/random/detail/sha1_simd.ipp>
+#undef BOOST_RANDOM_DETAIL_SIMD_TARGET
+} // namespace avx2
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+namespace avx512{
+#define BOOST_RANDOM_DETAIL_SIMD_TARGET BOOST_RANDOM_DETAIL_AVX512_TARGET
+#include <boost/random/detail/sha1_simd.ipp>
+#undef BOOST_RANDOM_DETAIL_SIMD_TARGET
+} // namespace avx512
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_AVX2) || defined(BOOST_RANDOM_HAVE_AVX512)
+// sha1_kernel_test<Ndomain, Nkey, Version> - the self-test, like
+// prf_kernel_test (see simd_dispatch.hpp), with s0 from the key.
+template <unsigned Ndomain, unsigned Nkey, unsigned Version>
+struct sha1_kernel_test{
+    typedef sha1_prf<Ndomain, Nkey, Version> prf_type;
+    typedef typename prf_type::key_type key_type;
+    typedef typename prf_type::domain_type domain_type;
+    typedef typename prf_type::range_type range_type;
+    typedef std::size_t (*kernel_type)(const key_type&, const uint32_t (&)[5], const domain_type*, range_type*, std::size_t);
+
+    bool operator()(kernel_type kernel) const{
+        uint64_t x = 0;
+        key_type k;
+        selftest_words(k, x);
+        domain_type in[selftest_size];
+        range_type out[selftest_size];
+        for(std::size_t i=0; i<selftest_size; ++i)
+            selftest_words(in[i], x);
+        sha1_prf_midstate<Version> mid;
+        mid.setkey(k);
+        uint32_t s0[5];
+        mid.start(s0);
+        std::size_t m = kernel(k, s0, in, out, selftest_size);
+        if( m > selftest_size )
+            return false;
+        const prf_type prf(k);
+        for(std::size_t i=0; i<m; ++i)
+            if( out[i] != prf(in[i]) )
+                return false;
+        return true;
+    }
+};
+
+template <unsigned Ndomain, unsigned Nkey, unsigned Version>
+struct sha1_simd<Ndomain, Nkey, Version, true>{
+    typedef boost::array<uint32_t, Ndomain> domain_type;
+    typedef boost::array<uint32_t, 5> range_type;
+    typedef boost::array<uint32_t, Nkey> key_type;
+    typedef std::size_t (*kernel_type)(const key_type&, const uint32_t (&)[5], const domain_type*, range_type*, std::size_t);
+
+    static kernel_type kernel(simd_level l){
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+        if( l == simd_avx512 )
+            return &avx512::sha1_kernel<Ndomain, Nkey, Version>::apply;
+#endif
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+        if( l == simd_avx2 )
+            return &avx2::sha1_kernel<Ndomain, Nkey, Version>::apply;
+#endif
+        (void)l;
+        return 0;
+    }
+
+    static kernel_type selected(){
+        static const kernel_type k = select_kernel<sha1_simd>(sha1_kernel_test<Ndomain, Nkey, Version>());
+        return k;
+    }
+
+    static std::size_t apply(const key_type& k, const uint32_t (&s0)[5], const domain_type* in, range_type* out, std::size_t n){
+        kernel_type kern = selected();
+        return kern ? kern(k, s0, in, out, n) : 0;
+    }
+};
+#endif // BOOST_RANDOM_HAVE_AVX2 || BOOST_RANDOM_HAVE_AVX512
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_SHA1_SIMD_HPP
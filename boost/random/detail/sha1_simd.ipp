@@ -0,0 +1,61 @@
+// Copyright 2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// No include guard:  sha1_simd.hpp includes this once for each
+// instruction set, inside its namespace (avx2 or avx512), with
+// BOOST_RANDOM_DETAIL_SIMD_TARGET defined as its target attribute.
+// The kernel is written in terms of the namespace's vec32 and unroll
+// (see simd.hpp), and sha1_rounds_v, from sha1_rounds.ipp.
+
+#include <boost/random/detail/sha1_rounds.ipp>
+
+template <unsigned Ndomain, unsigned Nkey, unsigned Version>
+struct sha1_kernel{
+    typedef vec32 V;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = V::lanes);
+    BOOST_STATIC_CONSTANT(unsigned, T0 = Version==2 ? Nkey : 0);
+    typedef boost::array<uint32_t, Ndomain> domain_type;
+    typedef boost::array<uint32_t, 5> range_type;
+    typedef boost::array<uint32_t, Nkey> key_type;
+
+    BOOST_RANDOM_DETAIL_SIMD_TARGET
+    static std::size_t apply(const key_type& k, const uint32_t (&s0)[5], const domain_type* in, range_type* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        for(std::size_t i=0; i<m; i+=lanes)
+            applyN(k, s0, in+i, out+i);
+        return m;
+    }
+
+protected:
+    BOOST_RANDOM_DETAIL_SIMD_TARGET
+    static void applyN(const key_type& k, const uint32_t (&s0)[5], const domain_type* in, range_type* out){
+        uint32_t buf[16][lanes];
+        for(unsigned j=0; j<lanes; ++j){
+            uint32_t w[16];
+            sha1_block_words<Version>(k, in[j], w);
+            for(unsigned t=0; t<16; ++t)
+                buf[t][j] = w[t];
+        }
+        sha1_rounds_v<V> r;
+        for(unsigned t=0; t<16; ++t)
+            r.w[t] = V::load(buf[t]);
+        r.a = V::set1(s0[0]);
+        r.b = V::set1(s0[1]);
+        r.c = V::set1(s0[2]);
+        r.d = V::set1(s0[3]);
+        r.e = V::set1(s0[4]);
+        unroll<80, T0>::apply(r);
+        uint32_t h0[5];
+        sha1_init(h0);
+        V::store(buf[0], V::add(r.a, V::set1(h0[0])));
+        V::store(buf[1], V::add(r.b, V::set1(h0[1])));
+        V::store(buf[2], V::add(r.c, V::set1(h0[2])));
+        V::store(buf[3], V::add(r.d, V::set1(h0[3])));
+        V::store(buf[4], V::add(r.e, V::set1(h0[4])));
+        for(unsigned j=0; j<lanes; ++j)
+            for(unsigned i=0; i<5; ++i)
+                out[j][i] = buf[i][j];
+    }
+};
@@ -0,0 +1,386 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_SIMD_HPP
+#define BOOST_RANDOM_DETAIL_SIMD_HPP
+
+// Odds and ends shared by the multi-lane kernels in philox_simd.hpp,
+// threefry_simd.hpp, sha1_simd.hpp and uniform01_simd.hpp.
+//
+// The kernels are compiled for every instruction set the compiler can
+// generate, whatever the target of the rest of the program (e.g.,
+// without -march=native), and the one to use is chosen at run time
+// (see simd_dispatch.hpp).  With gcc and clang, that takes a target
+// attribute on every function a kernel calls, down to the helpers
+// here:
+//
+//   BOOST_RANDOM_HAVE_SSE41    BOOST_RANDOM_DETAIL_SSE41_TARGET
+//   BOOST_RANDOM_HAVE_AVX2     BOOST_RANDOM_DETAIL_AVX2_TARGET
+//   BOOST_RANDOM_HAVE_AVX512   BOOST_RANDOM_DETAIL_AVX512_TARGET
+//
+// are defined when the compiler can compile the kernels for SSE4.1,
+// AVX2 and AVX-512 (F and DQ), and they're the attributes to put on
+// them (MSVC doesn't need any).  Define BOOST_RANDOM_NO_SIMD_DISPATCH
+// to compile only the kernels for instructions the compiler was told
+// the target has, as with a compiler we don't know, e.g., with
+// -march=native.  Either way, cpu_features() (see cpu_features.hpp)
+// says which of them it's safe to call.
+//
+// The avx2 and avx512 namespaces each have an unroll (see unroll.hpp)
+// compiled for their instruction set, and vec32 and vec64 typedefs
+// (below), so that a kernel written in terms of those can be included
+// into either one (see threefry_simd.ipp and sha1_simd.ipp).
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/detail/cpu_features.hpp>
+#include <boost/random/detail/unroll.hpp>
+
+#if !defined(BOOST_RANDOM_NO_SIMD_DISPATCH) && defined(BOOST_RANDOM_DETAIL_CPUID_GNUC) && (defined(__clang__) || __GNUC__ >= 5)
+#include <immintrin.h>
+#define BOOST_RANDOM_HAVE_SSE41
+#define BOOST_RANDOM_HAVE_AVX2
+#define BOOST_RANDOM_HAVE_AVX512
+#define BOOST_RANDOM_DETAIL_SSE41_TARGET __attribute__((target("sse4.1")))
+#define BOOST_RANDOM_DETAIL_AVX2_TARGET __attribute__((target("avx2")))
+#define BOOST_RANDOM_DETAIL_AVX512_TARGET __attribute__((target("avx512f,avx512dq")))
+#elif !defined(BOOST_RANDOM_NO_SIMD_DISPATCH) && defined(BOOST_RANDOM_DETAIL_CPUID_MSVC) && _MSC_VER >= 1900
+#include <immintrin.h>
+#define BOOST_RANDOM_HAVE_SSE41
+#define BOOST_RANDOM_HAVE_AVX2
+#define BOOST_RANDOM_DETAIL_SSE41_TARGET
+#define BOOST_RANDOM_DETAIL_AVX2_TARGET
+#if _MSC_VER >= 1911
+#define BOOST_RANDOM_HAVE_AVX512
+#define BOOST_RANDOM_DETAIL_AVX512_TARGET
+#endif
+#else
+#if defined(__SSE4_1__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE4_1__)
+#define BOOST_RANDOM_HAVE_SSE41
+#define BOOST_RANDOM_DETAIL_SSE41_TARGET
+#endif
+#if defined(__AVX2__)
+#define BOOST_RANDOM_HAVE_AVX2
+#define BOOST_RANDOM_DETAIL_AVX2_TARGET
+#endif
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+#define BOOST_RANDOM_HAVE_AVX512
+#define BOOST_RANDOM_DETAIL_AVX512_TARGET
+#endif
+#endif
+
+// gcc 12's AVX-512 intrinsics start from _mm512_undefined_epi32(), a
+// self-initialized variable that -Wuninitialized and
+// -Wmaybe-uninitialized flag wherever they're inlined - a false
+// positive.  The AVX-512 kernels are bracketed with these.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 5
+#define BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH                  \
+    _Pragma("GCC diagnostic push")                                \
+    _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")         \
+    _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP _Pragma("GCC diagnostic pop")
+#else
+#define BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+#define BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif
+
+namespace boost{
+namespace random{
+namespace detail{
+
+// soa_load and soa_store move a group of consecutive counters (each
+// one an N-word boost::array, stored contiguously) between memory and
+// N vector registers, with c[j] holding word j of every counter in
+// the group.  The order of the counters across the lanes of c[j] is
+// unspecified - it's whatever is cheapest - but soa_store always puts
+// them back where soa_load found them.  The number of counters in a
+// group is the number of lanes in the vector type.
+
+#if defined(BOOST_RANDOM_HAVE_SSE41)
+// Four counters of 4x32 bits.  A 4x4 transpose is its own inverse,
+// and the lanes hold counters 0..3 in order.
+BOOST_RANDOM_DETAIL_SSE41_TARGET
+inline void transpose4x32(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3){
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t2 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+    r0 = _mm_unpacklo_epi64(t0, t2);
+    r1 = _mm_unpackhi_epi64(t0, t2);
+    r2 = _mm_unpacklo_epi64(t1, t3);
+    r3 = _mm_unpackhi_epi64(t1, t3);
+}
+
+BOOST_RANDOM_DETAIL_SSE41_TARGET
+inline void soa_load(const uint32_t* p, __m128i (&c)[4]){
+    for(unsigned j=0; j<4; ++j)
+        c[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p+4*j));
+    transpose4x32(c[0], c[1], c[2], c[3]);
+}
+
+BOOST_RANDOM_DETAIL_SSE41_TARGET
+inline void soa_store(uint32_t* p, const __m128i (&c)[4]){
+    __m128i r0 = c[0], r1 = c[1], r2 = c[2], r3 = c[3];
+    transpose4x32(r0, r1, r2, r3);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p),    r0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p+4),  r1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p+8),  r2);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p+12), r3);
+}
+#endif // BOOST_RANDOM_HAVE_SSE41
+
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+// Eight counters of 4x32 bits.  The 4x4 transpose works within each
+// 128-bit half, so the lanes hold counters 0,2,4,6,1,3,5,7.
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+inline void soa_load(const uint32_t* p, __m256i (&c)[4]){
+    __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p+8));
+    __m256i r2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p+16));
+    __m256i r3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p+24));
+    __m256i t0 = _mm256_unpacklo_epi32(r0, r1);
+    __m256i t1 = _mm256_unpackhi_epi32(r0, r1);
+    __m256i t2 = _mm256_unpacklo_epi32(r2, r3);
+    __m256i t3 = _mm256_unpackhi_epi32(r2, r3);
+    c[0] = _mm256_unpacklo_epi64(t0, t2);
+    c[1] = _mm256_unpackhi_epi64(t0, t2);
+    c[2] = _mm256_unpacklo_epi64(t1, t3);
+    c[3] = _mm256_unpackhi_epi64(t1, t3);
+}
+
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+inline void soa_store(uint32_t* p, const __m256i (&c)[4]){
+    __m256i u0 = _mm256_unpacklo_epi32(c[0], c[1]);
+    __m256i u1 = _mm256_unpackhi_epi32(c[0], c[1]);
+    __m256i u2 = _mm256_unpacklo_epi32(c[2], c[3]);
+    __m256i u3 = _mm256_unpackhi_epi32(c[2], c[3]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p),    _mm256_unpacklo_epi64(u0, u2));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p+8),  _mm256_unpackhi_epi64(u0, u2));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p+16), _mm256_unpacklo_epi64(u1, u3));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p+24), _mm256_unpackhi_epi64(u1, u3));
+}
+
+// Four counters of 4x64 bits.  A 4x4 transpose is its own inverse.
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+inline void transpose4x64(__m256i& r0, __m256i& r1, __m256i& r2, __m256i& r3){
+    __m256i t0 = _mm256_unpacklo_epi64(r0, r1);
+    __m256i t1 = _mm256_unpackhi_epi64(r0, r1);
+    __m256i t2 = _mm256_unpacklo_epi64(r2, r3);
+    __m256i t3 = _mm256_unpackhi_epi64(r2, r3);
+    r0 = _mm256_permute2x128_si256(t0, t2, 0x20);
+    r1 = _mm256_permute2x128_si256(t1, t3, 0x20);
+    r2 = _mm256_permute2x128_si256(t0, t2, 0x31);
+    r3 = _mm256_permute2x128_si256(t1, t3, 0x31);
+}
+
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+inline void soa_load(const uint64_t* p, __m256i (&c)[4]){
+    for(unsigned j=0; j<4; ++j)
+        c[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p+4*j));
+    transpose4x64(c[0], c[1], c[2], c[3]);
+}
+
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+inline void soa_store(uint64_t* p, const __m256i (&c)[4]){
+    __m256i r0 = c[0], r1 = c[1], r2 = c[2], r3 = c[3];
+    transpose4x64(r0, r1, r2, r3);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p),    r0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p+4),  r1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p+8),  r2);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p+12), r3);
+}
+
+// Four counters of 2x64 bits.  The lanes hold counters 0,2,1,3.
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+inline void soa_load(const uint64_t* p, __m256i (&c)[2]){
+    __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p+4));
+    c[0] = _mm256_unpacklo_epi64(r0, r1);
+    c[1] = _mm256_unpackhi_epi64(r0, r1);
+}
+
+BOOST_RANDOM_DETAIL_AVX2_TARGET
+inline void soa_store(uint64_t* p, const __m256i (&c)[2]){
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p),   _mm256_unpacklo_epi64(c[0], c[1]));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p+4), _mm256_unpackhi_epi64(c[0], c[1]));
+}
+#endif // BOOST_RANDOM_HAVE_AVX2
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+BOOST_RANDOM_DETAIL_AVX512_TARGET
+inline __m512i permute_idx(long long i0, long long i1, long long i2, long long i3,
+                           long long i4, long long i5, long long i6, long long i7){
+    return _mm512_set_epi64(i7, i6, i5, i4, i3, i2, i1, i0);
+}
+
+// Eight counters of 4x64 bits, with two rounds of two-register
+// permutes.  The lanes hold counters 0..7 in order.
+BOOST_RANDOM_DETAIL_AVX512_TARGET
+inline void soa_load(const uint64_t* p, __m512i (&c)[4]){
+    const __m512i w01 = permute_idx(0, 4, 8, 12, 1, 5, 9, 13);
+    const __m512i w23 = permute_idx(2, 6, 10, 14, 3, 7, 11, 15);
+    const __m512i lo = permute_idx(0, 1, 2, 3, 8, 9, 10, 11);
+    const __m512i hi = permute_idx(4, 5, 6, 7, 12, 13, 14, 15);
+    __m512i r0 = _mm512_loadu_si512(p);
+    __m512i r1 = _mm512_loadu_si512(p+8);
+    __m512i r2 = _mm512_loadu_si512(p+16);
+    __m512i r3 = _mm512_loadu_si512(p+24);
+    __m512i t0 = _mm512_permutex2var_epi64(r0, w01, r1);
+    __m512i t1 = _mm512_permutex2var_epi64(r0, w23, r1);
+    __m512i t2 = _mm512_permutex2var_epi64(r2, w01, r3);
+    __m512i t3 = _mm512_permutex2var_epi64(r2, w23, r3);
+    c[0] = _mm512_permutex2var_epi64(t0, lo, t2);
+    c[1] = _mm512_permutex2var_epi64(t0, hi, t2);
+    c[2] = _mm512_permutex2var_epi64(t1, lo, t3);
+    c[3] = _mm512_permutex2var_epi64(t1, hi, t3);
+}
+
+BOOST_RANDOM_DETAIL_AVX512_TARGET
+inline void soa_store(uint64_t* p, const __m512i (&c)[4]){
+    const __m512i lo = permute_idx(0, 8, 1, 9, 2, 10, 3, 11);
+    const __m512i hi = permute_idx(4, 12, 5, 13, 6, 14, 7, 15);
+    const __m512i c01 = permute_idx(0, 1, 8, 9, 2, 3, 10, 11);
+    const __m512i c23 = permute_idx(4, 5, 12, 13, 6, 7, 14, 15);
+    __m512i t0 = _mm512_permutex2var_epi64(c[0], lo, c[1]);
+    __m512i t1 = _mm512_permutex2var_epi64(c[0], hi, c[1]);
+    __m512i u0 = _mm512_permutex2var_epi64(c[2], lo, c[3]);
+    __m512i u1 = _mm512_permutex2var_epi64(c[2], hi, c[3]);
+    _mm512_storeu_si512(p,    _mm512_permutex2var_epi64(t0, c01, u0));
+    _mm512_storeu_si512(p+8,  _mm512_permutex2var_epi64(t0, c23, u0));
+    _mm512_storeu_si512(p+16, _mm512_permutex2var_epi64(t1, c01, u1));
+    _mm512_storeu_si512(p+24, _mm512_permutex2var_epi64(t1, c23, u1));
+}
+
+// Eight counters of 2x64 bits.  The lanes hold counters 0..7 in order.
+BOOST_RANDOM_DETAIL_AVX512_TARGET
+inline void soa_load(const uint64_t* p, __m512i (&c)[2]){
+    __m512i r0 = _mm512_loadu_si512(p);
+    __m512i r1 = _mm512_loadu_si512(p+8);
+    c[0] = _mm512_permutex2var_epi64(r0, permute_idx(0, 2, 4, 6, 8, 10, 12, 14), r1);
+    c[1] = _mm512_permutex2var_epi64(r0, permute_idx(1, 3, 5, 7, 9, 11, 13, 15), r1);
+}
+
+BOOST_RANDOM_DETAIL_AVX512_TARGET
+inline void soa_store(uint64_t* p, const __m512i (&c)[2]){
+    _mm512_storeu_si512(p,   _mm512_permutex2var_epi64(c[0], permute_idx(0, 8, 1, 9, 2, 10, 3, 11), c[1]));
+    _mm512_storeu_si512(p+8, _mm512_permutex2var_epi64(c[0], permute_idx(4, 12, 5, 13, 6, 14, 7, 15), c[1]));
+}
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif // BOOST_RANDOM_HAVE_AVX512
+
+// vec64_avx2 and vec64_avx512 - the handful of operations on vectors
+// of 64-bit lanes that the threefry kernels need, so that one kernel
+// can be written for both.  (They're plain structs rather than
+// specializations of a template on the vector type because gcc warns
+// that it ignores the vector types' attributes in template arguments.)
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+struct vec64_avx2{
+    typedef __m256i type;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 4);
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i set1(uint64_t x){ return _mm256_set1_epi64x(x); }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i add(__m256i a, __m256i b){ return _mm256_add_epi64(a, b); }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i xor_(__m256i a, __m256i b){ return _mm256_xor_si256(a, b); }
+    // AVX2 has no vector rotate, so we emulate it with shifts.
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i rotl(__m256i x, unsigned s){
+        return _mm256_or_si256(_mm256_sll_epi64(x, _mm_cvtsi32_si128(s)),
+                               _mm256_srl_epi64(x, _mm_cvtsi32_si128(64-s)));
+    }
+};
+#endif // BOOST_RANDOM_HAVE_AVX2
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+struct vec64_avx512{
+    typedef __m512i type;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 8);
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i set1(uint64_t x){ return _mm512_set1_epi64(x); }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i add(__m512i a, __m512i b){ return _mm512_add_epi64(a, b); }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i xor_(__m512i a, __m512i b){ return _mm512_xor_si512(a, b); }
+    // vprolvq is a native 64-bit rotate.
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i rotl(__m512i x, unsigned s){
+        return _mm512_rolv_epi64(x, _mm512_set1_epi64(s));
+    }
+};
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif // BOOST_RANDOM_HAVE_AVX512
+
+// vec32_avx2 and vec32_avx512 - the same idea for vectors of 32-bit
+// lanes, with the three SHA-1 round functions:
+//   ch(b, c, d) = (b & c) | (~b & d)
+//   parity(b, c, d) = b ^ c ^ d
+//   maj(b, c, d) = (b & c) | (b & d) | (c & d)
+// AVX-512 does each of them with one vpternlogd, whose immediate is
+// the function's truth table:  bit 4*b+2*c+d of it is the result for
+// bits b, c and d.
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+struct vec32_avx2{
+    typedef __m256i type;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 8);
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i load(const uint32_t* p){ return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static void store(uint32_t* p, __m256i x){ _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x); }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i set1(uint32_t x){ return _mm256_set1_epi32(x); }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i add(__m256i a, __m256i b){ return _mm256_add_epi32(a, b); }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i xor_(__m256i a, __m256i b){ return _mm256_xor_si256(a, b); }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i rotl(__m256i x, unsigned s){
+        return _mm256_or_si256(_mm256_sll_epi32(x, _mm_cvtsi32_si128(s)),
+                               _mm256_srl_epi32(x, _mm_cvtsi32_si128(32-s)));
+    }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i ch(__m256i b, __m256i c, __m256i d){
+        return _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d)));
+    }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i parity(__m256i b, __m256i c, __m256i d){
+        return _mm256_xor_si256(b, _mm256_xor_si256(c, d));
+    }
+    BOOST_RANDOM_DETAIL_AVX2_TARGET static __m256i maj(__m256i b, __m256i c, __m256i d){
+        return _mm256_or_si256(_mm256_and_si256(b, c), _mm256_and_si256(d, _mm256_or_si256(b, c)));
+    }
+};
+#endif // BOOST_RANDOM_HAVE_AVX2
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+struct vec32_avx512{
+    typedef __m512i type;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 16);
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i load(const uint32_t* p){ return _mm512_loadu_si512(p); }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static void store(uint32_t* p, __m512i x){ _mm512_storeu_si512(p, x); }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i set1(uint32_t x){ return _mm512_set1_epi32(x); }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i add(__m512i a, __m512i b){ return _mm512_add_epi32(a, b); }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i xor_(__m512i a, __m512i b){ return _mm512_xor_si512(a, b); }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i rotl(__m512i x, unsigned s){
+        return _mm512_rolv_epi32(x, _mm512_set1_epi32(s));
+    }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i ch(__m512i b, __m512i c, __m512i d){ return _mm512_ternarylogic_epi32(b, c, d, 0xca); }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i parity(__m512i b, __m512i c, __m512i d){ return _mm512_ternarylogic_epi32(b, c, d, 0x96); }
+    BOOST_RANDOM_DETAIL_AVX512_TARGET static __m512i maj(__m512i b, __m512i c, __m512i d){ return _mm512_ternarylogic_epi32(b, c, d, 0xe8); }
+};
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif // BOOST_RANDOM_HAVE_AVX512
+
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+namespace avx2{
+BOOST_RANDOM_DETAIL_DEFINE_UNROLL(unroll, BOOST_RANDOM_DETAIL_AVX2_TARGET);
+typedef vec32_avx2 vec32;
+typedef vec64_avx2 vec64;
+} // namespace avx2
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+namespace avx512{
+BOOST_RANDOM_DETAIL_DEFINE_UNROLL(unroll, BOOST_RANDOM_DETAIL_AVX512_TARGET);
+typedef vec32_avx512 vec32;
+typedef vec64_avx512 vec64;
+} // namespace avx512
+#endif
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_SIMD_HPP
@@ -0,0 +1,109 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_SIMD_DISPATCH_HPP
+#define BOOST_RANDOM_DETAIL_SIMD_DISPATCH_HPP
+
+// Run-time selection of the multi-lane kernels.  The kernels are
+// compiled for every instruction set the compiler can target (see
+// simd.hpp), so one binary can use AVX-512 on the CPUs that have it
+// and still run on the ones that don't.  A family of kernels, e.g.,
+// philox_simd<4, uint32_t, R, Constants>, provides
+//
+//   typedef ... kernel_type;                   // a function pointer
+//   static kernel_type kernel(simd_level l);   // its kernel for l, or 0
+//
+// and select_kernel<Kernels>(test) returns the kernel for the highest
+// level no higher than cpu_simd_level() (which BOOST_RANDOM_SIMD can
+// lower - see cpu_features.hpp) that passes test, or 0 if none does,
+// in which case the caller does everything with its scalar code.
+//
+// test is a self-test:  test(kernel) runs the kernel on a fixed set of
+// inputs and compares its results with the scalar code's, which the
+// known-answer tests pin down.  It should never fail, but if it does -
+// a miscompiled kernel, or a CPU or hypervisor that claims features it
+// doesn't have - we'd rather be slower than wrong, and select_kernel
+// quietly moves on to the next level down.
+//
+// The kernels' callers select once, the first time they're called,
+// and keep the result in a function-local static.
+
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/detail/cpu_features.hpp>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+namespace detail{
+
+template <typename Kernels, typename Test>
+typename Kernels::kernel_type select_kernel(const Test& test){
+    for(int l=cpu_simd_level(); l>simd_scalar; --l){
+        typename Kernels::kernel_type kernel = Kernels::kernel(simd_level(l));
+        if( kernel && test(kernel) )
+            return kernel;
+    }
+    return 0;
+}
+
+// The self-tests use this many inputs.  It's enough to go through
+// both the two-group and the one-group code in kernels with 4, 8 or
+// 16 lanes (see philox_simd.hpp).
+const std::size_t selftest_size = 60;
+
+// selftest_word<Uint>(x) - the next word of the self-tests' inputs,
+// from a 64-bit LCG whose state is x, with the high bits folded in.
+// The unit tests draw their keys and counters from it too.
+template <typename Uint>
+inline Uint selftest_word(uint64_t& x){
+    x = x*UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+    return Uint(x ^ (x>>29));
+}
+
+template <typename Uint, std::size_t N>
+inline void selftest_words(boost::array<Uint, N>& a, uint64_t& x){
+    for(std::size_t j=0; j<N; ++j)
+        a[j] = selftest_word<Uint>(x);
+}
+
+// prf_kernel_test<Prf> - the self-test for kernels that evaluate a
+// Prf on many counters with the same key (see philox_simd.hpp):
+//
+//   std::size_t kernel(const key_type& k, const domain_type* in,
+//                      range_type* out, std::size_t n);
+//
+// sets out[i] = Prf(k)(in[i]) for i in [0, m), and returns m <= n.
+template <typename Prf>
+struct prf_kernel_test{
+    typedef typename Prf::key_type key_type;
+    typedef typename Prf::domain_type domain_type;
+    typedef typename Prf::range_type range_type;
+    typedef std::size_t (*kernel_type)(const key_type&, const domain_type*, range_type*, std::size_t);
+
+    bool operator()(kernel_type kernel) const{
+        uint64_t x = 0;
+        key_type k;
+        selftest_words(k, x);
+        domain_type in[selftest_size];
+        range_type out[selftest_size];
+        for(std::size_t i=0; i<selftest_size; ++i)
+            selftest_words(in[i], x);
+        std::size_t m = kernel(k, in, out, selftest_size);
+        if( m > selftest_size )
+            return false;
+        const Prf prf(k);
+        for(std::size_t i=0; i<m; ++i)
+            if( out[i] != prf(in[i]) )
+                return false;
+        return true;
+    }
+};
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_SIMD_DISPATCH_HPP
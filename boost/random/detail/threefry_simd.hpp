@@ -0,0 +1,135 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_THREEFRY_SIMD_HPP
+#define BOOST_RANDOM_DETAIL_THREEFRY_SIMD_HPP
+
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/detail/simd.hpp>
+#include <boost/random/detail/simd_dispatch.hpp>
+#include <boost/random/detail/unroll.hpp>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+
+// The self-tests check the kernels against threefry itself.
+template <unsigned N, typename Uint, unsigned R, typename Constants, bool CacheKeySchedule>
+struct threefry;
+
+namespace detail{
+
+// threefry_simd - multi-lane kernels that evaluate threefry on several
+// independent counters at once, all with the same key.  The interface
+// is the same as philox_simd's (see philox_simd.hpp):
+//
+//   static std::size_t apply(const key_type& k, const domain_type* in,
+//                            range_type* out, std::size_t n);
+//
+// computes out[i] = threefry(k)(in[i]) for the largest multiple of
+// the kernel's lane count that is <= n, and returns how many it did.
+//
+// Threefry is nothing but adds, rotates and xors, so it vectorizes
+// beautifully.  The 64-bit variants have kernels for AVX-512 (eight
+// lanes, with native vprolvq rotates) and AVX2 (four lanes, with
+// rotates emulated by shifts), and apply uses the best one the CPU
+// has (see simd_dispatch.hpp).  The same kernels, in
+// threefry_simd.ipp, written in terms of vec64, serve both.
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+struct threefry_simd{
+    template <typename KeyType, typename DomainType, typename RangeType>
+    static std::size_t apply(const KeyType&, const DomainType*, RangeType*, std::size_t){
+        return 0;
+    }
+};
+
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+namespace avx2{
+#define BOOST_RANDOM_DETAIL_SIMD_TARGET BOOST_RANDOM_DETAIL_AVX2_TARGET
+#include <boost/random/detail/threefry_simd.ipp>
+#undef BOOST_RANDOM_DETAIL_SIMD_TARGET
+} // namespace avx2
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+namespace avx512{
+#define BOOST_RANDOM_DETAIL_SIMD_TARGET BOOST_RANDOM_DETAIL_AVX512_TARGET
+#include <boost/random/detail/threefry_simd.ipp>
+#undef BOOST_RANDOM_DETAIL_SIMD_TARGET
+} // namespace avx512
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_AVX2) || defined(BOOST_RANDOM_HAVE_AVX512)
+template <unsigned R, typename Constants>
+struct threefry_simd<2, uint64_t, R, Constants>{
+    typedef boost::array<uint64_t, 2> domain_type;
+    typedef boost::array<uint64_t, 2> range_type;
+    typedef boost::array<uint64_t, 2> key_type;
+    typedef std::size_t (*kernel_type)(const key_type&, const domain_type*, range_type*, std::size_t);
+
+    static kernel_type kernel(simd_level l){
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+        if( l == simd_avx512 )
+            return &avx512::threefry2x64_kernel<R, Constants>::apply;
+#endif
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+        if( l == simd_avx2 )
+            return &avx2::threefry2x64_kernel<R, Constants>::apply;
+#endif
+        (void)l;
+        return 0;
+    }
+
+    static kernel_type selected(){
+        static const kernel_type k = select_kernel<threefry_simd>(prf_kernel_test<threefry<2, uint64_t, R, Constants, false> >());
+        return k;
+    }
+
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        kernel_type kern = selected();
+        return kern ? kern(k, in, out, n) : 0;
+    }
+};
+
+template <unsigned R, typename Constants>
+struct threefry_simd<4, uint64_t, R, Constants>{
+    typedef boost::array<uint64_t, 4> domain_type;
+    typedef boost::array<uint64_t, 4> range_type;
+    typedef boost::array<uint64_t, 4> key_type;
+    typedef std::size_t (*kernel_type)(const key_type&, const domain_type*, range_type*, std::size_t);
+
+    static kernel_type kernel(simd_level l){
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+        if( l == simd_avx512 )
+            return &avx512::threefry4x64_kernel<R, Constants>::apply;
+#endif
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+        if( l == simd_avx2 )
+            return &avx2::threefry4x64_kernel<R, Constants>::apply;
+#endif
+        (void)l;
+        return 0;
+    }
+
+    static kernel_type selected(){
+        static const kernel_type k = select_kernel<threefry_simd>(prf_kernel_test<threefry<4, uint64_t, R, Constants, false> >());
+        return k;
+    }
+
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        kernel_type kern = selected();
+        return kern ? kern(k, in, out, n) : 0;
+    }
+};
+#endif // BOOST_RANDOM_HAVE_AVX2 || BOOST_RANDOM_HAVE_AVX512
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_THREEFRY_SIMD_HPP
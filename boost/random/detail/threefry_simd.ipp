@@ -0,0 +1,166 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+// No include guard:  threefry_simd.hpp includes this once for each
+// instruction set, inside its namespace (avx2 or avx512), with
+// BOOST_RANDOM_DETAIL_SIMD_TARGET defined as its target attribute.
+// The kernels are written in terms of the namespace's vec64 and
+// unroll (see simd.hpp).
+
+template <unsigned R, typename Constants>
+struct threefry2x64_kernel{
+    typedef vec64 ops;
+    typedef ops::type V;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = ops::lanes);
+    typedef boost::array<uint64_t, 2> domain_type;
+    typedef boost::array<uint64_t, 2> range_type;
+    typedef boost::array<uint64_t, 2> key_type;
+
+    BOOST_RANDOM_DETAIL_SIMD_TARGET
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        std::size_t i = 0;
+        for( ; i+2*lanes<=m; i+=2*lanes)
+            applyG<2>(k, in+i, out+i);
+        if( i<m )
+            applyG<1>(k, in+i, out+i);
+        return m;
+    }
+
+protected:
+    // applyG evaluates G interleaved groups of 'lanes' counters, to
+    // give the out-of-order core independent work while each group
+    // waits on its add->rotate->xor chain.
+    template <unsigned G>
+    BOOST_RANDOM_DETAIL_SIMD_TARGET
+    static inline void applyG(const key_type& k, const domain_type* in, range_type* out){
+        uint64_t ks[3];
+        ks[2] = Constants::KS_PARITY;
+        ks[0] = k[0]; ks[2] ^= k[0];
+        ks[1] = k[1]; ks[2] ^= k[1];
+        const V ks0 = ops::set1(ks[0]);
+        const V ks1 = ops::set1(ks[1]);
+
+        V c[G][2];
+        for(unsigned g=0; g<G; ++g){
+            soa_load(in[lanes*g].data(), c[g]);
+            c[g][0] = ops::add(c[g][0], ks0);
+            c[g][1] = ops::add(c[g][1], ks1);
+        }
+
+        // As in threefry itself, the rounds are unrolled, so the
+        // rotation counts are constants.
+        _rounds<G> rs(c, ks);
+        unroll<R>::apply(rs);
+
+        for(unsigned g=0; g<G; ++g)
+            soa_store(out[lanes*g].data(), c[g]);
+    }
+
+    template <unsigned G>
+    struct _rounds{
+        V (&c)[G][2];
+        const uint64_t* ks;
+        _rounds(V (&_c)[G][2], const uint64_t* _ks) : c(_c), ks(_ks){}
+        template <unsigned r>
+        BOOST_RANDOM_DETAIL_SIMD_TARGET BOOST_FORCEINLINE void round(){
+            const unsigned rot = Constants::Rotations[r%8];
+            for(unsigned g=0; g<G; ++g){
+                c[g][0] = ops::add(c[g][0], c[g][1]);
+                c[g][1] = ops::xor_(ops::rotl(c[g][1], rot), c[g][0]);
+            }
+            if(((r+1)&3)==0){
+                const unsigned r4 = (r+1)>>2;
+                const V inj0 = ops::set1(ks[r4%3]);
+                const V inj1 = ops::set1(ks[(r4+1)%3] + r4);
+                for(unsigned g=0; g<G; ++g){
+                    c[g][0] = ops::add(c[g][0], inj0);
+                    c[g][1] = ops::add(c[g][1], inj1);
+                }
+            }
+        }
+    };
+};
+
+template <unsigned R, typename Constants>
+struct threefry4x64_kernel{
+    typedef vec64 ops;
+    typedef ops::type V;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = ops::lanes);
+    typedef boost::array<uint64_t, 4> domain_type;
+    typedef boost::array<uint64_t, 4> range_type;
+    typedef boost::array<uint64_t, 4> key_type;
+
+    BOOST_RANDOM_DETAIL_SIMD_TARGET
+    static std::size_t apply(const key_type& k, const domain_type* in, range_type* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        std::size_t i = 0;
+        for( ; i+2*lanes<=m; i+=2*lanes)
+            applyG<2>(k, in+i, out+i);
+        if( i<m )
+            applyG<1>(k, in+i, out+i);
+        return m;
+    }
+
+protected:
+    template <unsigned G>
+    BOOST_RANDOM_DETAIL_SIMD_TARGET
+    static inline void applyG(const key_type& k, const domain_type* in, range_type* out){
+        uint64_t ks[5];
+        ks[4] = Constants::KS_PARITY;
+        for(unsigned j=0; j<4; ++j){
+            ks[j] = k[j];
+            ks[4] ^= k[j];
+        }
+
+        V c[G][4];
+        for(unsigned g=0; g<G; ++g){
+            soa_load(in[lanes*g].data(), c[g]);
+            for(unsigned j=0; j<4; ++j)
+                c[g][j] = ops::add(c[g][j], ops::set1(ks[j]));
+        }
+
+        _rounds<G> rs(c, ks);
+        unroll<R>::apply(rs);
+
+        for(unsigned g=0; g<G; ++g)
+            soa_store(out[lanes*g].data(), c[g]);
+    }
+
+    template <unsigned G>
+    struct _rounds{
+        V (&c)[G][4];
+        const uint64_t* ks;
+        _rounds(V (&_c)[G][4], const uint64_t* _ks) : c(_c), ks(_ks){}
+        template <unsigned r>
+        BOOST_RANDOM_DETAIL_SIMD_TARGET BOOST_FORCEINLINE void round(){
+            const unsigned rot0 = Constants::Rotations0[r%8];
+            const unsigned rot1 = Constants::Rotations1[r%8];
+            for(unsigned g=0; g<G; ++g){
+                if((r&1)==0){
+                    c[g][0] = ops::add(c[g][0], c[g][1]);
+                    c[g][1] = ops::xor_(ops::rotl(c[g][1], rot0), c[g][0]);
+                    c[g][2] = ops::add(c[g][2], c[g][3]);
+                    c[g][3] = ops::xor_(ops::rotl(c[g][3], rot1), c[g][2]);
+                }else{
+                    c[g][0] = ops::add(c[g][0], c[g][3]);
+                    c[g][3] = ops::xor_(ops::rotl(c[g][3], rot0), c[g][0]);
+                    c[g][2] = ops::add(c[g][2], c[g][1]);
+                    c[g][1] = ops::xor_(ops::rotl(c[g][1], rot1), c[g][2]);
+                }
+            }
+            if(((r+1)&3)==0){
+                const unsigned r4 = (r+1)>>2;
+                V inj[4];
+                for(unsigned j=0; j<3; ++j)
+                    inj[j] = ops::set1(ks[(r4+j)%5]);
+                inj[3] = ops::set1(ks[(r4+3)%5] + r4);
+                for(unsigned g=0; g<G; ++g)
+                    for(unsigned j=0; j<4; ++j)
+                        c[g][j] = ops::add(c[g][j], inj[j]);
+            }
+        }
+    };
+};
@@ -0,0 +1,264 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_UNIFORM01_SIMD_HPP
+#define BOOST_RANDOM_DETAIL_UNIFORM01_SIMD_HPP
+
+#include <boost/cstdint.hpp>
+#include <boost/random/detail/simd.hpp>
+#include <boost/random/detail/simd_dispatch.hpp>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+namespace detail{
+
+// uniform01_simd - multi-lane versions of uniform01_converter (see
+// fill_uniform01.hpp), in the style of philox_simd:
+//
+//   static std::size_t apply(const Converter& conv, const Uint* in,
+//                            Real* out, std::size_t n);
+//
+// sets out[i] = conv(in[i]) for the largest multiple of the kernel's
+// lane count that is <= n, and returns how many it did.  They do the
+// same (exact) arithmetic in the same order as the scalar converter,
+// so the results are identical.  There are kernels for AVX2 and
+// AVX-512, and apply uses the best one the CPU has (see
+// simd_dispatch.hpp).
+//
+// float from 32-bit words is a shift and a vcvtdq2ps.  double from
+// 64-bit words needs an int64-to-double conversion, which is native
+// only with AVX-512DQ.  With AVX2 we use the usual trick:  or-ing the
+// low 52 bits of k into the significand of 2^52 and subtracting 2^52
+// gives them exactly, and the 53rd bit (if there is one) is added
+// back as 0 or 2^52.
+template <typename Real, typename Uint, unsigned w, uniform01_interval I>
+struct uniform01_simd{
+    template <typename Converter>
+    static std::size_t apply(const Converter&, const Uint*, Real*, std::size_t){
+        return 0;
+    }
+};
+
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+namespace avx2{
+template <uniform01_interval I>
+struct uniform01_float_kernel{
+    typedef uniform01_converter<float, uint32_t, 32, I> converter_t;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 8);
+    BOOST_RANDOM_DETAIL_AVX2_TARGET
+    static std::size_t apply(const converter_t& conv, const uint32_t* in, float* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        const __m256 scale = _mm256_set1_ps(conv.scale);
+        const __m256 divisor = _mm256_set1_ps(conv.divisor);
+        const __m256 one = _mm256_set1_ps(1.f);
+        for(std::size_t i=0; i<m; i+=lanes){
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in+i));
+            __m256 k = _mm256_cvtepi32_ps(_mm256_srli_epi32(x, converter_t::shift));
+            if( converter_t::divide ){
+                k = _mm256_div_ps(k, divisor);
+            }else{
+                if( converter_t::twice )
+                    k = _mm256_add_ps(k, k);
+                if( converter_t::plus1 )
+                    k = _mm256_add_ps(k, one);
+                k = _mm256_mul_ps(k, scale);
+            }
+            _mm256_storeu_ps(out+i, k);
+        }
+        return m;
+    }
+};
+
+template <uniform01_interval I>
+struct uniform01_double_kernel{
+    typedef uniform01_converter<double, uint64_t, 64, I> converter_t;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 4);
+    BOOST_RANDOM_DETAIL_AVX2_TARGET
+    static std::size_t apply(const converter_t& conv, const uint64_t* in, double* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        const __m256d scale = _mm256_set1_pd(conv.scale);
+        const __m256d divisor = _mm256_set1_pd(conv.divisor);
+        const __m256d one = _mm256_set1_pd(1.);
+        const __m256d two52 = _mm256_set1_pd(4503599627370496.0);
+        const __m256i low52 = _mm256_set1_epi64x(INT64_C(0x000FFFFFFFFFFFFF));
+        const __m256i two52bits = _mm256_castpd_si256(two52);
+        for(std::size_t i=0; i<m; i+=lanes){
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in+i));
+            __m256i ki = _mm256_srli_epi64(x, converter_t::shift);
+            __m256d lo = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(ki, low52), two52bits)), two52);
+            __m256i hibit = _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_srli_epi64(ki, 52));
+            __m256d k = _mm256_add_pd(lo, _mm256_and_pd(_mm256_castsi256_pd(hibit), two52));
+            if( converter_t::divide ){
+                k = _mm256_div_pd(k, divisor);
+            }else{
+                if( converter_t::twice )
+                    k = _mm256_add_pd(k, k);
+                if( converter_t::plus1 )
+                    k = _mm256_add_pd(k, one);
+                k = _mm256_mul_pd(k, scale);
+            }
+            _mm256_storeu_pd(out+i, k);
+        }
+        return m;
+    }
+};
+} // namespace avx2
+#endif // BOOST_RANDOM_HAVE_AVX2
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+namespace avx512{
+template <uniform01_interval I>
+struct uniform01_float_kernel{
+    typedef uniform01_converter<float, uint32_t, 32, I> converter_t;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 16);
+    BOOST_RANDOM_DETAIL_AVX512_TARGET
+    static std::size_t apply(const converter_t& conv, const uint32_t* in, float* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        const __m512 scale = _mm512_set1_ps(conv.scale);
+        const __m512 divisor = _mm512_set1_ps(conv.divisor);
+        const __m512 one = _mm512_set1_ps(1.f);
+        for(std::size_t i=0; i<m; i+=lanes){
+            __m512i x = _mm512_loadu_si512(in+i);
+            __m512 k = _mm512_cvtepi32_ps(_mm512_srli_epi32(x, converter_t::shift));
+            if( converter_t::divide ){
+                k = _mm512_div_ps(k, divisor);
+            }else{
+                if( converter_t::twice )
+                    k = _mm512_add_ps(k, k);
+                if( converter_t::plus1 )
+                    k = _mm512_add_ps(k, one);
+                k = _mm512_mul_ps(k, scale);
+            }
+            _mm512_storeu_ps(out+i, k);
+        }
+        return m;
+    }
+};
+
+template <uniform01_interval I>
+struct uniform01_double_kernel{
+    typedef uniform01_converter<double, uint64_t, 64, I> converter_t;
+    BOOST_STATIC_CONSTANT(unsigned, lanes = 8);
+    BOOST_RANDOM_DETAIL_AVX512_TARGET
+    static std::size_t apply(const converter_t& conv, const uint64_t* in, double* out, std::size_t n){
+        std::size_t m = n - n%lanes;
+        const __m512d scale = _mm512_set1_pd(conv.scale);
+        const __m512d divisor = _mm512_set1_pd(conv.divisor);
+        const __m512d one = _mm512_set1_pd(1.);
+        for(std::size_t i=0; i<m; i+=lanes){
+            __m512i x = _mm512_loadu_si512(in+i);
+            __m512d k = _mm512_cvtepi64_pd(_mm512_srli_epi64(x, converter_t::shift));
+            if( converter_t::divide ){
+                k = _mm512_div_pd(k, divisor);
+            }else{
+                if( converter_t::twice )
+                    k = _mm512_add_pd(k, k);
+                if( converter_t::plus1 )
+                    k = _mm512_add_pd(k, one);
+                k = _mm512_mul_pd(k, scale);
+            }
+            _mm512_storeu_pd(out+i, k);
+        }
+        return m;
+    }
+};
+} // namespace avx512
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif // BOOST_RANDOM_HAVE_AVX512
+
+#if defined(BOOST_RANDOM_HAVE_AVX2) || defined(BOOST_RANDOM_HAVE_AVX512)
+// uniform01_kernel_test<Real, Uint, w, I> - the self-test, like
+// prf_kernel_test (see simd_dispatch.hpp), against the converter.
+// The inputs start with the extremes, 0 and all ones.
+template <typename Real, typename Uint, unsigned w, uniform01_interval I>
+struct uniform01_kernel_test{
+    typedef uniform01_converter<Real, Uint, w, I> converter_t;
+    typedef std::size_t (*kernel_type)(const converter_t&, const Uint*, Real*, std::size_t);
+
+    bool operator()(kernel_type kernel) const{
+        uint64_t x = 0;
+        Uint in[selftest_size];
+        Real out[selftest_size];
+        in[0] = 0;
+        in[1] = Uint(~Uint(0));
+        for(std::size_t i=2; i<selftest_size; ++i)
+            in[i] = selftest_word<Uint>(x);
+        const converter_t conv;
+        std::size_t m = kernel(conv, in, out, selftest_size);
+        if( m > selftest_size )
+            return false;
+        for(std::size_t i=0; i<m; ++i)
+            if( out[i] != conv(in[i]) )
+                return false;
+        return true;
+    }
+};
+
+template <uniform01_interval I>
+struct uniform01_simd<float, uint32_t, 32, I>{
+    typedef uniform01_converter<float, uint32_t, 32, I> converter_t;
+    typedef std::size_t (*kernel_type)(const converter_t&, const uint32_t*, float*, std::size_t);
+
+    static kernel_type kernel(simd_level l){
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+        if( l == simd_avx512 )
+            return &avx512::uniform01_float_kernel<I>::apply;
+#endif
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+        if( l == simd_avx2 )
+            return &avx2::uniform01_float_kernel<I>::apply;
+#endif
+        (void)l;
+        return 0;
+    }
+
+    static kernel_type selected(){
+        static const kernel_type k = select_kernel<uniform01_simd>(uniform01_kernel_test<float, uint32_t, 32, I>());
+        return k;
+    }
+
+    static std::size_t apply(const converter_t& conv, const uint32_t* in, float* out, std::size_t n){
+        kernel_type kern = selected();
+        return kern ? kern(conv, in, out, n) : 0;
+    }
+};
+
+template <uniform01_interval I>
+struct uniform01_simd<double, uint64_t, 64, I>{
+    typedef uniform01_converter<double, uint64_t, 64, I> converter_t;
+    typedef std::size_t (*kernel_type)(const converter_t&, const uint64_t*, double*, std::size_t);
+
+    static kernel_type kernel(simd_level l){
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+        if( l == simd_avx512 )
+            return &avx512::uniform01_double_kernel<I>::apply;
+#endif
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+        if( l == simd_avx2 )
+            return &avx2::uniform01_double_kernel<I>::apply;
+#endif
+        (void)l;
+        return 0;
+    }
+
+    static kernel_type selected(){
+        static const kernel_type k = select_kernel<uniform01_simd>(uniform01_kernel_test<double, uint64_t, 64, I>());
+        return k;
+    }
+
+    static std::size_t apply(const converter_t& conv, const uint64_t* in, double* out, std::size_t n){
+        kernel_type kern = selected();
+        return kern ? kern(conv, in, out, n) : 0;
+    }
+};
+#endif // BOOST_RANDOM_HAVE_AVX2 || BOOST_RANDOM_HAVE_AVX512
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_UNIFORM01_SIMD_HPP
@@ -0,0 +1,68 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_DETAIL_UNROLL_HPP
+#define BOOST_RANDOM_DETAIL_UNROLL_HPP
+
+#include <boost/config.hpp>
+
+namespace boost{
+namespace random{
+namespace detail{
+
+// unroll<R>::apply(f) calls
+//
+//    f.template round<0>(); f.template round<1>(); ... f.template round<R-1>();
+//
+// by template recursion.  The round number is a compile-time
+// constant in every call, so anything computed from it, e.g., a
+// rotation amount looked up in a table of constants or whether
+// there's a key injection after this round, is a constant too.
+// Unlike a for loop, or mpl::for_each, which passes the round number
+// as a function argument, this doesn't leave the unrolling (or the
+// constant propagation) to the whims of the compiler's inlining
+// heuristics.
+template <unsigned R, unsigned I = 0>
+struct unroll{
+    template <typename F>
+    static BOOST_FORCEINLINE void apply(F& f){
+        f.template round<I>();
+        unroll<R, I+1>::apply(f);
+    }
+};
+
+template <unsigned R>
+struct unroll<R, R>{
+    template <typename F>
+    static BOOST_FORCEINLINE void apply(F&){}
+};
+
+// BOOST_RANDOM_DETAIL_DEFINE_UNROLL(name, target) defines another
+// unroll, called name, in the current namespace, with target, a
+// function attribute like gcc's __attribute__((target("avx2"))), on
+// its apply.  It's for the SIMD kernels that are compiled for an
+// instruction set the rest of the program isn't (see simd.hpp):  gcc
+// won't inline a kernel's round<r> into an unroll<R>::apply that
+// isn't compiled for the same instructions, always_inline or not.
+#define BOOST_RANDOM_DETAIL_DEFINE_UNROLL(name, target)       \
+    template <unsigned R, unsigned I = 0>                     \
+    struct name{                                              \
+        template <typename F>                                 \
+        target static BOOST_FORCEINLINE void apply(F& f){     \
+            f.template round<I>();                            \
+            name<R, I+1>::apply(f);                           \
+        }                                                     \
+    };                                                        \
+    template <unsigned R>                                     \
+    struct name<R, R>{                                        \
+        template <typename F>                                 \
+        target static BOOST_FORCEINLINE void apply(F&){}      \
+    }
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_DETAIL_UNROLL_HPP
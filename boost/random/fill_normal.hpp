@@ -0,0 +1,76 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_FILL_NORMAL_HPP
+#define BOOST_RANDOM_FILL_NORMAL_HPP
+
+#include <boost/random/detail/box_muller.hpp>
+#include <algorithm>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+
+// fill_normal - assign n normally distributed values with the given
+//  mean and standard deviation to out[0, n), by the Box-Muller
+//  transform of the engine's next outputs.  Each pair of outputs
+//  makes a pair of normals (see detail/box_muller.hpp for exactly
+//  how), so, e.g., one block of a 4x32 Prf makes four floats, and one
+//  block of a 4x64 Prf makes four doubles.  If n is odd, the last
+//  pair's sine is computed and thrown away - the engine always
+//  advances by an even number, 2*ceil(n/2), of outputs.
+//
+//     counter_based_engine<uint32_t, philox<4, uint32_t> > eng(key);
+//     eng.restart(...);
+//     fill_normal(eng, v, 3*Natoms, 0.f, rmsvelocity);
+//
+//  The words come from the engine's fill method a few hundred at a
+//  time, and they're converted in groups by straight-line code that
+//  the compiler vectorizes, with polynomial approximations rather than
+//  calls to log, sin and cos.  The results depend only on the
+//  engine's output, not on n or on how the work was split into calls
+//  (as long as each call but the last asks for an even number of
+//  values), and every value is computed by the same code, so the
+//  vector width doesn't change them either.  (But a build that
+//  contracts a*b+c into fused multiply-adds, e.g., for a target with
+//  FMA, can differ in the last bit from one that doesn't.)  They are
+//  *not* the same as normal_distribution's, which uses the ziggurat
+//  method and consumes a variable number of engine outputs per value.
+//
+//  The Engine must have a fill method, like counter_based_engine and
+//  buffered_counter_based_engine.
+template <typename Real, typename Engine>
+void fill_normal(Engine& e, Real* out, std::size_t n, Real mean = Real(0), Real sigma = Real(1)){
+    typedef typename Engine::result_type Uint;
+    typedef detail::box_muller_group<Real, Uint, Engine::word_size> group_t;
+    static const std::size_t G = group_t::G;
+    static const std::size_t Ngroups = 16;
+    const group_t bm;
+    Uint in[2*G*Ngroups];
+    Real partial[2*G];
+    while( n ){
+        std::size_t m = (std::min)(n, 2*G*Ngroups);
+        std::size_t words = m + (m&1);
+        e.fill(in, in+words);
+        // The last group may be padded with zeros, whose normals are
+        // discarded.
+        std::size_t padded = (words + 2*G - 1)/(2*G)*(2*G);
+        std::fill(in+words, in+padded, Uint(0));
+        std::size_t i = 0;
+        for( ; i+2*G<=m; i+=2*G)
+            bm(in+i, out+i, mean, sigma);
+        if( i<m ){
+            bm(in+i, partial, mean, sigma);
+            std::copy(partial, partial+(m-i), out+i);
+        }
+        out += m;
+        n -= m;
+    }
+}
+
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_FILL_NORMAL_HPP
@@ -0,0 +1,145 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_FILL_UNIFORM01_HPP
+#define BOOST_RANDOM_FILL_UNIFORM01_HPP
+
+#include <boost/config.hpp>
+#include <boost/limits.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/integer/static_min_max.hpp>
+#include <boost/type_traits/make_signed.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace boost{
+namespace random{
+
+// The intervals that fill_uniform01 can fill.
+enum uniform01_interval{
+    u01_closed_open,    // [0, 1)
+    u01_open_closed,    // (0, 1]
+    u01_open_open,      // (0, 1)
+    u01_closed_closed   // [0, 1]
+};
+
+namespace detail{
+
+// uniform01_converter - the conversion of one w-bit random word, x,
+//  to a floating point value in the given interval.  With
+//  p = min(digits of Real, w), it uses the top p bits of x, k, and
+//  returns:
+//
+//    u01_closed_open:    k * 2^-p
+//    u01_open_closed:    (k + 1) * 2^-p
+//    u01_open_open:      (2k + 1) * 2^-p, with p one less, so that
+//                        2k+1 fits in the significand.
+//    u01_closed_closed:  k / (2^p - 1)
+//
+//  I.e., the results are evenly spaced, and symmetric about 1/2 in
+//  the open-open and closed-closed cases.  Every step but the
+//  division is exact, and the division is correctly rounded, so the
+//  results don't depend on the compiler, optimization, FMA
+//  contraction or SIMD-vs-scalar.  The multi-lane kernels in
+//  uniform01_simd.hpp do exactly the same arithmetic.
+template <typename Real, typename Uint, unsigned w, uniform01_interval I>
+struct uniform01_converter{
+    BOOST_STATIC_ASSERT(!std::numeric_limits<Real>::is_integer);
+    BOOST_STATIC_ASSERT(std::numeric_limits<Real>::radix == 2);
+    BOOST_STATIC_ASSERT(w <= unsigned(std::numeric_limits<Uint>::digits));
+    BOOST_STATIC_CONSTANT(unsigned, digits = std::numeric_limits<Real>::digits);
+    BOOST_STATIC_CONSTANT(bool, twice = (I == u01_open_open));
+    BOOST_STATIC_CONSTANT(bool, plus1 = (I == u01_open_closed || I == u01_open_open));
+    BOOST_STATIC_CONSTANT(bool, divide = (I == u01_closed_closed));
+    BOOST_STATIC_CONSTANT(unsigned, bits = (static_unsigned_min<(twice ? digits-1 : digits), w>::value));
+    BOOST_STATIC_CONSTANT(unsigned, shift = w - bits);
+
+    uniform01_converter() :
+        scale(std::ldexp(Real(1), -int(twice ? bits+1 : bits))),
+        divisor(std::ldexp(Real(1), int(bits)) - Real(1))
+    {}
+
+    Real operator()(Uint x) const{
+        // When the top bit is shifted out, k is also a non-negative
+        // signed integer, and signed-to-float is the conversion that
+        // every SIMD instruction set has.
+        Real k = shift ? static_cast<Real>(static_cast<typename make_signed<Uint>::type>(x >> shift))
+                       : static_cast<Real>(x);
+        if( divide )
+            return k / divisor;
+        if( twice )
+            k = k + k;
+        if( plus1 )
+            k = k + Real(1);
+        return k * scale;
+    }
+
+    Real scale;
+    Real divisor;
+};
+
+} // namespace detail
+} // namespace random
+} // namespace boost
+
+#include <boost/random/detail/uniform01_simd.hpp>
+
+namespace boost{
+namespace random{
+
+// fill_uniform01 - assign n uniformly distributed floating point
+//  values in the interval I (by default, [0, 1)) to out[0, n), one for
+//  each of the engine's next n outputs, converted as described for
+//  detail::uniform01_converter above.
+//
+//     counter_based_engine<uint64_t, philox<4, uint64_t> > eng;
+//     fill_uniform01(eng, doubles, n);
+//     fill_uniform01<float, u01_open_open>(eng32, floats, n);
+//
+//  The words come from the engine's fill method, a few hundred at a
+//  time, so the Prf is evaluated a whole block (or batch of blocks) at
+//  a time, and they're converted by SIMD kernels where there are
+//  any: float from 32-bit words and double from 64-bit words with
+//  AVX2 or AVX-512.  Other combinations, e.g., double from 32-bit
+//  words (32 random bits per double), are converted one at a time.
+//  Either way, the values are bit-for-bit the same.
+//
+//  Compared with uniform_01 or uniform_real_distribution, this makes
+//  one call into the engine per few hundred values, rather than per
+//  value, and the conversion is a shift, an int-to-float conversion
+//  and a multiply.  Note that the values are *not* the same as
+//  uniform_01's.
+//
+//  The Engine must have a fill method, like counter_based_engine and
+//  buffered_counter_based_engine.
+template <typename Real, uniform01_interval I, typename Engine>
+void fill_uniform01(Engine& e, Real* out, std::size_t n){
+    typedef typename Engine::result_type Uint;
+    typedef detail::uniform01_converter<Real, Uint, Engine::word_size, I> converter_t;
+    typedef detail::uniform01_simd<Real, Uint, Engine::word_size, I> simd_t;
+    static const std::size_t Nbuf = 512;
+    const converter_t conv;
+    Uint buf[Nbuf];
+    while( n ){
+        std::size_t m = (std::min)(n, Nbuf);
+        e.fill(buf, buf+m);
+        std::size_t i = simd_t::apply(conv, buf, out, m);
+        for( ; i<m; ++i)
+            out[i] = conv(buf[i]);
+        out += m;
+        n -= m;
+    }
+}
+
+template <typename Real, typename Engine>
+void fill_uniform01(Engine& e, Real* out, std::size_t n){
+    fill_uniform01<Real, u01_closed_open>(e, out, n);
+}
+
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_FILL_UNIFORM01_HPP
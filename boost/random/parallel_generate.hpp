@@ -0,0 +1,118 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#ifndef BOOST_RANDOM_PARALLEL_GENERATE_HPP
+#define BOOST_RANDOM_PARALLEL_GENERATE_HPP
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind/bind.hpp>
+#include <iterator>
+#include <algorithm>
+
+namespace boost{
+namespace random{
+
+namespace detail{
+
+template <typename Engine, typename RandomAccessIter>
+void parallel_generate_chunk(const Engine& e, boost::uintmax_t offset, RandomAccessIter first, RandomAccessIter last){
+    Engine ec(e);
+    ec.discard(offset);
+    ec.fill(first, last);
+}
+
+} // namespace detail
+
+// parallel_generate - assign the next std::distance(first, last)
+//  values of a counter-based engine's sequence to [first, last),
+//  using nthreads threads.  The output, and the state the engine is
+//  left in, are exactly the same as from engine.fill(first, last),
+//  or std::generate(first, last, engine), no matter how many threads
+//  there are.
+//
+//  The range is cut into nthreads contiguous chunks.  Each chunk is
+//  filled by a copy of the engine that has been moved to the chunk's
+//  start by discard(), i.e., by counter arithmetic - never by
+//  re-seeding or restarting.  The chunk lengths are multiples of
+//  results_per_counter(), so every chunk starts at the same place in
+//  a block of the Prf's output as the whole range does, and if that's
+//  the beginning of a block (e.g., right after a seed or restart, or
+//  after filling whole blocks), no Prf output is computed twice.
+//  Each thread uses the engine's fill(), so it takes advantage of the
+//  Prf's batch operator(), if it has one.
+//
+//  The calling thread fills the first chunk itself, so nthreads-1
+//  threads are started, and they're all joined before
+//  parallel_generate returns.  If nthreads is zero,
+//  boost::thread::hardware_concurrency() is used.  Ranges too short to
+//  be worth a thread are filled serially.
+//
+//  Engine is a counter_based_engine or buffered_counter_based_engine,
+//  or anything else with an O(1) discard and a fill method.
+//  RandomAccessIter must be a random access iterator, and threads must
+//  be able to assign through different iterators into the range
+//  concurrently, e.g., a pointer or a std::vector iterator.
+//
+//  If the range extends past the end of the engine's sequence,
+//  parallel_generate throws before it starts any threads, and neither
+//  the engine nor the range is modified.
+template <typename Engine, typename RandomAccessIter>
+void parallel_generate(Engine& e, RandomAccessIter first, RandomAccessIter last, unsigned nthreads = 0){
+    // Below this many values per thread, starting threads costs more
+    // than it saves.
+    static const boost::uintmax_t min_chunk = 4096;
+    typedef typename std::iterator_traits<RandomAccessIter>::difference_type difference_type;
+    const boost::uintmax_t n = std::distance(first, last);
+    const boost::uintmax_t Nresult = e.results_per_counter();
+
+    if( nthreads == 0 )
+        nthreads = boost::thread::hardware_concurrency();
+    if( nthreads == 0 )
+        nthreads = 1;
+    if( n/min_chunk < nthreads )
+        nthreads = static_cast<unsigned>(n/min_chunk);
+
+    // This throws if there aren't n values left in the sequence,
+    // before anything has been written, serial or not.
+    Engine after(e);
+    after.discard(n);
+
+    if( nthreads <= 1 ){
+        detail::parallel_generate_chunk(e, 0, first, last);
+        e = after;
+        return;
+    }
+
+    // Chunk lengths are rounded up to whole blocks.  That leaves the
+    // last chunk short, possibly even empty.
+    boost::uintmax_t nblocks = (n + Nresult - 1)/Nresult;
+    boost::uintmax_t chunk = (nblocks + nthreads - 1)/nthreads * Nresult;
+
+    boost::thread_group threads;
+    try{
+        for(unsigned t=1; t<nthreads; ++t){
+            boost::uintmax_t lo = t*chunk;
+            if( lo >= n )
+                break;
+            boost::uintmax_t hi = (lo + chunk < n) ? lo + chunk : n;
+            threads.create_thread(boost::bind(&detail::parallel_generate_chunk<Engine, RandomAccessIter>,
+                                              boost::cref(e), lo,
+                                              first + static_cast<difference_type>(lo),
+                                              first + static_cast<difference_type>(hi)));
+        }
+        detail::parallel_generate_chunk(e, 0, first, first + static_cast<difference_type>((std::min)(chunk, n)));
+    }catch(...){
+        threads.join_all();
+        throw;
+    }
+    threads.join_all();
+    e = after;
+}
+
+} // namespace random
+} // namespace boost
+
+#endif // BOOST_RANDOM_PARALLEL_GENERATE_HPP
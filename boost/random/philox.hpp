@@ -11,8 +11,11 @@
 #include <boost/cstdint.hpp>
 #include <boost/limits.hpp>
 #include <boost/random/detail/mulhilo.hpp>
+#include <boost/random/detail/philox_simd.hpp>
+#include <boost/random/detail/unroll.hpp>
 #include <boost/mpl/for_each.hpp>
 #include <boost/mpl/range_c.hpp>
+#include <cstddef>
 
 namespace boost{
 namespace random{
@@ -51,20 +54,27 @@ struct philox_constants<4, uint32_t>{
     static const uint32_t W1 = UINT64_C(0xBB67AE85);  /* sqrt(3)-1 */
 };
 
-template <unsigned N, typename Uint, unsigned R=10, typename Constants = philox_constants<N, Uint> >
+// philox<N, Uint, R, Constants, CacheKeySchedule>
+//
+// With CacheKeySchedule=false (the default), philox stores only its
+// key, and bumps a copy of it by the Weyl constants in every round of
+// every call.  With CacheKeySchedule=true, the R round keys are
+// computed once, by the constructors and setkey, and kept in the
+// object, at a cost of R*N/2 words.  The results are the same either
+// way.
+template <unsigned N, typename Uint, unsigned R=10, typename Constants = philox_constants<N, Uint>, bool CacheKeySchedule=false>
 struct philox{
     BOOST_STATIC_ASSERT( N%2 == 0 );
 };
 
 template <typename Uint, unsigned R, typename Constants>
-struct philox<2, Uint, R, Constants> {
+struct philox<2, Uint, R, Constants, false> {
     typedef array<Uint, 2> domain_type;
     typedef array<Uint, 2> range_type;
     typedef array<Uint, 1> key_type ;
 
     philox() : k(){}
     philox(key_type _k) : k(_k) {}
-    philox(const philox& v) : k(v.k){}
 
     void setkey(key_type _k){
         k = _k;
@@ -82,9 +92,12 @@ struct philox<2, Uint, R, Constants> {
         return k != rhs.k;
     }
 
-    range_type operator()(domain_type c){
+    range_type operator()(domain_type c) const{
         key_type kcopy = k;
-#if 0   // using mpl to unroll the loop doesn't seem to help much.
+#if !defined(BOOST_RANDOM_NO_UNROLLED_ROUNDS)
+        _roundapplyer ra(c, kcopy);
+        detail::unroll<R>::apply(ra);
+#elif 0   // using mpl to unroll the loop doesn't seem to help much.
         _roundapplyer ra(c, kcopy);
         mpl::for_each<mpl::range_c<unsigned, 0, R> >(ra);
 #else
@@ -93,8 +106,16 @@ struct philox<2, Uint, R, Constants> {
 #endif
         return c;
     }
+
+    // Batch evaluation: out[i] = (*this)(in[i]) for i in [0, n).
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        std::size_t i = detail::philox_simd<2, Uint, R, Constants>::apply(k, in, out, n);
+        for( ; i<n; ++i)
+            out[i] = (*this)(in[i]);
+    }
+
 protected:
-    static inline void round(domain_type& ctr, key_type& key){
+    static BOOST_FORCEINLINE void round(domain_type& ctr, key_type& key){
         Uint hi;
         Uint lo = detail::mulhilo(Constants::M0, ctr[0], hi);
         domain_type out = {{hi^key[0]^ctr[1], lo}};
@@ -106,13 +127,15 @@ protected:
         domain_type& c;
         key_type& k;
         _roundapplyer(domain_type& _c, key_type& _k): c(_c), k(_k){}
-        void operator()(unsigned){ round(c, k); }
+        void operator()(unsigned){ philox::round(c, k); }
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){ philox::round(c, k); }
     };
     key_type k;
 };
 
 template<typename Uint, unsigned R, typename Constants>
-struct philox<4, Uint, R, Constants> {
+struct philox<4, Uint, R, Constants, false> {
     typedef array<Uint, 4> domain_type;
     typedef array<Uint, 4> range_type;
     typedef array<Uint, 2> key_type ;
@@ -120,7 +143,6 @@ public:
 
     philox() : k(){}
     philox(key_type _k) : k(_k) {}
-    philox(const philox& v) : k(v.k){}
 
     void setkey(key_type _k){
         k = _k;
@@ -138,9 +160,12 @@ public:
         return k != rhs.k;
     }
 
-    range_type operator()(domain_type c){
+    range_type operator()(domain_type c) const{
         key_type kcopy = k;
-#if 0   // using mpl to unroll the loop doesn't seem to help much.
+#if !defined(BOOST_RANDOM_NO_UNROLLED_ROUNDS)
+        _roundapplyer ra(c, kcopy);
+        detail::unroll<R>::apply(ra);
+#elif 0   // using mpl to unroll the loop doesn't seem to help much.
         _roundapplyer ra(c, kcopy);
         mpl::for_each<mpl::range_c<unsigned, 0, R> >(ra);
 #else
@@ -150,8 +175,17 @@ public:
         return c;
     }
 
+    // Batch evaluation: out[i] = (*this)(in[i]) for i in [0, n).
+    // Multi-lane kernels from detail::philox_simd handle as many
+    // counters as they can, and we finish the rest one at a time.
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        std::size_t i = detail::philox_simd<4, Uint, R, Constants>::apply(k, in, out, n);
+        for( ; i<n; ++i)
+            out[i] = (*this)(in[i]);
+    }
+
 protected:
-    static inline void round(domain_type& ctr, key_type& key){
+    static BOOST_FORCEINLINE void round(domain_type& ctr, key_type& key){
         Uint hi0;
         Uint hi1;
         Uint lo0 = detail::mulhilo(Constants::M0, ctr[0], hi0);
@@ -167,12 +201,138 @@ protected:
         domain_type& c;
         key_type& k;
         _roundapplyer(domain_type& _c, key_type& _k): c(_c), k(_k){}
-        void operator()(unsigned){ round(c, k); }
+        void operator()(unsigned){ philox::round(c, k); }
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){ philox::round(c, k); }
     };
 
     key_type k;
 };
 
+// philox<N, Uint, R, Constants, true> - the same functions, with the
+// round keys cached:  rk[r] is the key used in round r.  They're
+// derived from the plain philox's, which is a private base, so that
+// the plain setkey can't be called behind the cache's back.  The key,
+// equality and batch operator() are re-exposed.  (The multi-lane
+// kernels bump their vector of keys once per round for a whole batch,
+// which costs next to nothing, so they use the plain key.)
+template<unsigned N, typename Uint, unsigned R, typename Constants>
+struct philox_cached_base : private philox<N, Uint, R, Constants, false>{
+    typedef philox<N, Uint, R, Constants, false> plain_type;
+    typedef typename plain_type::domain_type domain_type;
+    typedef typename plain_type::range_type range_type;
+    typedef typename plain_type::key_type key_type;
+
+    philox_cached_base() : plain_type() { schedule(); }
+    philox_cached_base(key_type _k) : plain_type(_k) { schedule(); }
+
+    void setkey(key_type _k){
+        plain_type::setkey(_k);
+        schedule();
+    }
+
+    using plain_type::getkey;
+
+    bool operator==(const philox_cached_base& rhs) const{
+        return getkey() == rhs.getkey();
+    }
+
+    bool operator!=(const philox_cached_base& rhs) const{
+        return getkey() != rhs.getkey();
+    }
+
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        plain_type::operator()(in, out, n);
+    }
+
+protected:
+    key_type rk[R];
+
+    // plain_type::round bumps its key argument by the Weyl
+    // constants, which is all we want from it here.
+    void schedule(){
+        key_type kr = this->k;
+        domain_type scratch = domain_type();
+        for(unsigned r=0; r<R; ++r){
+            rk[r] = kr;
+            plain_type::round(scratch, kr);
+        }
+    }
+};
+
+template<typename Uint, unsigned R, typename Constants>
+struct philox<2, Uint, R, Constants, true> : public philox_cached_base<2, Uint, R, Constants>{
+    typedef philox_cached_base<2, Uint, R, Constants> base_type;
+    typedef typename base_type::domain_type domain_type;
+    typedef typename base_type::range_type range_type;
+    typedef typename base_type::key_type key_type;
+
+    philox() : base_type() {}
+    philox(key_type _k) : base_type(_k) {}
+
+    range_type operator()(domain_type c) const{
+        _rounds rs(c, this->rk);
+        detail::unroll<R>::apply(rs);
+        return c;
+    }
+
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        base_type::operator()(in, out, n);
+    }
+
+protected:
+    struct _rounds{
+        domain_type& c;
+        const key_type* rk;
+        _rounds(domain_type& _c, const key_type* _rk) : c(_c), rk(_rk){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            Uint hi;
+            Uint lo = detail::mulhilo(Constants::M0, c[0], hi);
+            domain_type out = {{hi^rk[r][0]^c[1], lo}};
+            c = out;
+        }
+    };
+};
+
+template<typename Uint, unsigned R, typename Constants>
+struct philox<4, Uint, R, Constants, true> : public philox_cached_base<4, Uint, R, Constants>{
+    typedef philox_cached_base<4, Uint, R, Constants> base_type;
+    typedef typename base_type::domain_type domain_type;
+    typedef typename base_type::range_type range_type;
+    typedef typename base_type::key_type key_type;
+
+    philox() : base_type() {}
+    philox(key_type _k) : base_type(_k) {}
+
+    range_type operator()(domain_type c) const{
+        _rounds rs(c, this->rk);
+        detail::unroll<R>::apply(rs);
+        return c;
+    }
+
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        base_type::operator()(in, out, n);
+    }
+
+protected:
+    struct _rounds{
+        domain_type& c;
+        const key_type* rk;
+        _rounds(domain_type& _c, const key_type* _rk) : c(_c), rk(_rk){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            Uint hi0;
+            Uint hi1;
+            Uint lo0 = detail::mulhilo(Constants::M0, c[0], hi0);
+            Uint lo1 = detail::mulhilo(Constants::M1, c[2], hi1);
+            domain_type out = {{hi1^c[1]^rk[r][0], lo1,
+                                hi0^c[3]^rk[r][1], lo0}};
+            c = out;
+        }
+    };
+};
+
 } // namespace random
 } // namespace boost
 
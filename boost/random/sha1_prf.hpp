@@ -11,6 +11,10 @@
 #include <boost/array.hpp>
 #include <boost/uuid/sha1.hpp>
 #include <boost/cstdint.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/random/detail/sha1_block.hpp>
+#include <boost/random/detail/sha1_simd.hpp>
+#include <cstddef>
 
 namespace boost{
 namespace random{
@@ -27,9 +31,17 @@ namespace random{
 //   words to assign to the Pseudo-random function's domain and key.
 //   They have default values of 4 and 2.
 //
-//   Speed: random_speed.cpp reports that it's about 50x slower than
-//   fast generators like mersenne or threefry4x64.  On the other
-//   hand, it's faster than some of the 'ranlux' generators.
+//   Speed: hashing through uuids::detail::sha1, random_speed.cpp
+//   reported that it was about 50x slower than fast generators like
+//   mersenne or threefry4x64.  But with Nkey+Ndomain <= 13, the whole
+//   message fits in one 64-byte SHA-1 block, so operator() builds the
+//   padded block itself and calls the compression function once (see
+//   detail/sha1_block.hpp).  That's about 4x faster, and with the
+//   Intel SHA extensions, which are used if the CPU has them, it's
+//   about 8x faster.  The batch operator(), and hence
+//   counter_based_engine::fill, hashes 8 or 16 counters at once with
+//   AVX2 or AVX-512 (see detail/sha1_simd.hpp), which is another 2x
+//   or 4x.  The digests are the same either way.
 //
 //   Quality: Assuming that boost::uuids::detail::sha1 really is sha1,
 //   and that there are no bugs in counter_based_engine, then any
@@ -38,8 +50,21 @@ namespace random{
 //   surprise to the cryptography community and have huge implications
 //   for computer security.
 
-template <unsigned Ndomain=4, unsigned Nkey=2>
-class sha1_prf {
+// sha1_prf<Ndomain, Nkey, Version>
+//
+//   Version selects the layout of the hashed message.  Version 1, the
+//   default, is the original:  the byte Nkey, then the key and
+//   counter words.  Its digests never change, so streams and results
+//   recorded with it stay reproducible.  In Version 2, the key words
+//   come first, aligned with the block's words, then the counter, and
+//   the byte Nkey comes last.  So the first Nkey of SHA-1's 80 rounds
+//   depend only on the key, and sha1_prf computes them once, in
+//   setkey(), rather than for every counter.  Version 2 requires the
+//   message to fit in a single block, i.e., Nkey+Ndomain <= 13.  (The
+//   SHA-NI path does rounds four at a time and always starts from the
+//   top of the block, so it doesn't use the cached state.)
+template <unsigned Ndomain=4, unsigned Nkey=2, unsigned Version=1>
+class sha1_prf : protected detail::sha1_prf_midstate<Version> {
     // SHA-1 is spec'ed in terms of 32-bit, big-endian words.
     // But uuids::detail::sha1 only has byte-oriented input
     // functions that would be endian-sensitive if we passed
@@ -52,18 +77,19 @@ class sha1_prf {
         h.process_byte((v>> 8)&0xff);
         h.process_byte((v    )&0xff);
     }
+    typedef detail::sha1_prf_midstate<Version> midstate_type;
     
 public:
     typedef array<uint32_t, Ndomain> domain_type;
     typedef array<uint32_t, 5> range_type;
     typedef array<uint32_t, Nkey> key_type ;
 
-    sha1_prf() : k(){}
-    sha1_prf(key_type _k) : k(_k) {}
-    sha1_prf(const sha1_prf& v) : k(v.k){}
+    sha1_prf() : k(){ midstate_type::setkey(k); }
+    sha1_prf(key_type _k) : k(_k) { midstate_type::setkey(k); }
 
     void setkey(key_type _k){
         k = _k;
+        midstate_type::setkey(k);
     }
 
     key_type getkey() const{
@@ -78,12 +104,60 @@ public:
         return k != rhs.k;
     }
 
-    range_type operator()(domain_type c){
-        boost::uuids::detail::sha1 h;
+    range_type operator()(domain_type c) const{
         // salt with Nkey to disambiguate sha1_prf<Ndomain1,Nkey1>
         // from sha1_prf<Nkdomain2,Nkey2> when
         //   Ndomain1+Nkey1 == Nkdomain2+Nkey2
         BOOST_STATIC_ASSERT(uint8_t(Nkey) == Nkey);
+        return digest(c, boost::integral_constant<bool, single_block>());
+    }
+
+    // Batch evaluation (see detail/prf_batch.hpp).  With AVX2 or
+    // AVX-512, groups of 8 or 16 counters are hashed at once, one per
+    // lane, by detail::sha1_simd.  The leftovers, and everything when
+    // there are no multi-lane kernels, go through operator().
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        uint32_t s0[5];
+        this->start(s0);
+        std::size_t i = detail::sha1_simd<Ndomain, Nkey, Version, single_block>::apply(k, s0, in, out, n);
+        for( ; i<n; ++i)
+            out[i] = (*this)(in[i]);
+    }
+
+protected:
+    // The message is 1+4*(Nkey+Ndomain) bytes long.  It fits in one
+    // block, along with the 0x80 pad byte and the 8-byte bit count,
+    // if it's no longer than 55 bytes.
+    BOOST_STATIC_CONSTANT(unsigned, Nwords = Nkey+Ndomain);
+    BOOST_STATIC_CONSTANT(bool, single_block = (1+4*Nwords <= 55));
+    BOOST_STATIC_ASSERT(Version == 1 || Version == 2);
+    BOOST_STATIC_ASSERT(Version == 1 || single_block);
+
+    // The single-block digest, from a block we pad ourselves (see
+    // detail/sha1_block.hpp).
+    range_type digest(const domain_type& c, boost::true_type) const{
+        uint32_t w[16];
+        detail::sha1_block_words<Version>(this->k, c, w);
+        uint32_t h[5];
+        detail::sha1_init(h);
+        if( Version == 1 || detail::sha1_has_shani() ){
+            detail::sha1_compress(h, w);
+        }else{
+            uint32_t s[5];
+            this->start(s);
+            detail::sha1_rounds<Nkey, 80>(s, w);
+            for(unsigned i=0; i<5; ++i)
+                h[i] += s[i];
+        }
+        range_type ret;
+        for(unsigned i=0; i<5; ++i)
+            ret[i] = h[i];
+        return ret;
+    }
+
+    // Longer messages go through uuids::detail::sha1.
+    range_type digest(const domain_type& c, boost::false_type) const{
+        boost::uuids::detail::sha1 h;
         h.process_byte(Nkey);  
         for(unsigned i=0; i<Nkey; ++i)
             process_u32(h, this->k[i]);
@@ -94,7 +168,6 @@ public:
         return ret;
     }
 
-protected:
     key_type k;
 };
 
@@ -12,8 +12,11 @@
 #include <boost/cstdint.hpp>
 #include <boost/limits.hpp>
 #include <boost/random/detail/rotl.hpp>
+#include <boost/random/detail/unroll.hpp>
+#include <boost/random/detail/threefry_simd.hpp>
 #include <boost/mpl/range_c.hpp>
 #include <boost/mpl/for_each.hpp>
+#include <cstddef>
 
 namespace boost{
 namespace random{
@@ -84,7 +87,15 @@ const unsigned
 threefry_constants<4, uint64_t>::Rotations1[]  = {
     16, 57, 40, 37, 33, 12, 22, 32};
 
-template <unsigned N, typename Uint, unsigned R=20, typename Constants=threefry_constants<N, Uint> >
+// threefry<N, Uint, R, Constants, CacheKeySchedule>
+//
+// With CacheKeySchedule=false (the default), threefry stores only
+// its key, and works out the key schedule (the parity word and the
+// subkeys injected every four rounds) on every call.  With
+// CacheKeySchedule=true, the subkeys are computed once, by the
+// constructors and setkey, and kept in the object, at a cost of
+// (R/4+1)*N words.  The results are the same either way.
+template <unsigned N, typename Uint, unsigned R=20, typename Constants=threefry_constants<N, Uint>, bool CacheKeySchedule=false>
 struct threefry{
     BOOST_STATIC_ASSERT( N==2 || N==4 );
     // should never be instantiated.
@@ -94,14 +105,13 @@ struct threefry{
 
 // specialize threefry<2, Uint, R>
 template<typename Uint, unsigned R, typename Constants>
-struct threefry<2, Uint, R, Constants>{
+struct threefry<2, Uint, R, Constants, false>{
     typedef array<Uint, 2> domain_type;
     typedef array<Uint, 2> range_type;
     typedef array<Uint, 2> key_type ;
 
     threefry() : k(){}
     threefry(key_type _k) : k(_k) {}
-    threefry(const threefry& v) : k(v.k){}
 
     void setkey(key_type _k){
         k = _k;
@@ -119,12 +129,16 @@ struct threefry<2, Uint, R, Constants>{
         return k != rhs.k;
     }
 
-    domain_type operator()(domain_type c){ 
+    domain_type operator()(domain_type c) const{
         Uint ks[3];
         ks[2] = Constants::KS_PARITY;
         ks[0] = this->k[0]; ks[2] ^= this->k[0]; c[0] += this->k[0];
         ks[1] = this->k[1]; ks[2] ^= this->k[1]; c[1] += this->k[1];
-#if 1   // gcc doesn't want to unroll this without some help from mpl::for_each
+#if !defined(BOOST_RANDOM_NO_UNROLLED_ROUNDS)
+        _rounds rs(c, ks);
+        detail::unroll<R>::apply(rs);
+        return c;
+#elif 1   // gcc doesn't want to unroll this without some help from mpl::for_each
         _roundapplyer ra(c, ks);
         mpl::for_each<mpl::range_c<unsigned, 0, R> >( ra );
         return c;
@@ -142,7 +156,31 @@ struct threefry<2, Uint, R, Constants>{
 #endif
     }
 
+    // Batch evaluation: out[i] = (*this)(in[i]) for i in [0, n).
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        std::size_t i = detail::threefry_simd<2, Uint, R, Constants>::apply(k, in, out, n);
+        for( ; i<n; ++i)
+            out[i] = (*this)(in[i]);
+    }
+
 protected:
+    // _rounds - round<r> is round r, followed by a key injection if
+    // it's the last round in a group of four.  See detail/unroll.hpp.
+    struct _rounds{
+        domain_type& c;
+        const Uint* ks;
+        _rounds(domain_type& _c, const Uint* _ks) : c(_c), ks(_ks){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            c[0] += c[1]; c[1] = detail::rotl(c[1],Constants::Rotations[r%8]); c[1] ^= c[0];
+            if(((r+1)&3)==0){
+                const unsigned r4 = (r+1)>>2;
+                c[0] += ks[r4%3];
+                c[1] += ks[(r4+1)%3] + r4;
+            }
+        }
+    };
+
     struct _roundapplyer{
         domain_type& c;
         Uint* ks;
@@ -162,14 +200,13 @@ protected:
 
 // specialize threefry<4, Uint, R>
 template<typename Uint, unsigned R, typename Constants>
-struct threefry<4, Uint, R, Constants>{
+struct threefry<4, Uint, R, Constants, false>{
     typedef array<Uint, 4> domain_type;
     typedef array<Uint, 4> range_type;
     typedef array<Uint, 4> key_type ;
 
     threefry() : k(){}
     threefry(key_type _k) : k(_k) {}
-    threefry(const threefry& v) : k(v.k){}
 
     void setkey(key_type _k){
         k = _k;
@@ -187,7 +224,7 @@ struct threefry<4, Uint, R, Constants>{
         return k != rhs.k;
     }
 
-    range_type operator()(domain_type c){ 
+    range_type operator()(domain_type c) const{
         Uint ks[5];
         ks[4] = Constants::KS_PARITY;
         ks[0] = this->k[0]; ks[4] ^= this->k[0]; c[0] += this->k[0];
@@ -195,7 +232,11 @@ struct threefry<4, Uint, R, Constants>{
         ks[2] = this->k[2]; ks[4] ^= this->k[2]; c[2] += this->k[2];
         ks[3] = this->k[3]; ks[4] ^= this->k[3]; c[3] += this->k[3];
 
-#if 1   // gcc doesn't want to unroll this without some help from mpl::for_each
+#if !defined(BOOST_RANDOM_NO_UNROLLED_ROUNDS)
+        _rounds rs(c, ks);
+        detail::unroll<R>::apply(rs);
+        return c;
+#elif 1   // gcc doesn't want to unroll this without some help from mpl::for_each
         _roundapplyer ra(c, ks);
         mpl::for_each<mpl::range_c<unsigned, 0, R> >( ra );
         return c;
@@ -221,7 +262,39 @@ struct threefry<4, Uint, R, Constants>{
 #endif
     }
 
+    // Batch evaluation: out[i] = (*this)(in[i]) for i in [0, n).
+    // Multi-lane kernels from detail::threefry_simd handle as many
+    // counters as they can, and we finish the rest one at a time.
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        std::size_t i = detail::threefry_simd<4, Uint, R, Constants>::apply(k, in, out, n);
+        for( ; i<n; ++i)
+            out[i] = (*this)(in[i]);
+    }
+
 protected:
+    struct _rounds{
+        domain_type& c;
+        const Uint* ks;
+        _rounds(domain_type& _c, const Uint* _ks) : c(_c), ks(_ks){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            if((r&1)==0){
+                c[0] += c[1]; c[1] = detail::rotl(c[1],Constants::Rotations0[r%8]); c[1] ^= c[0];
+                c[2] += c[3]; c[3] = detail::rotl(c[3],Constants::Rotations1[r%8]); c[3] ^= c[2];
+            }else{
+                c[0] += c[3]; c[3] = detail::rotl(c[3],Constants::Rotations0[r%8]); c[3] ^= c[0];
+                c[2] += c[1]; c[1] = detail::rotl(c[1],Constants::Rotations1[r%8]); c[1] ^= c[2];
+            }
+            if(((r+1)&3)==0){
+                const unsigned r4 = (r+1)>>2;
+                c[0] += ks[(r4+0)%5];
+                c[1] += ks[(r4+1)%5];
+                c[2] += ks[(r4+2)%5];
+                c[3] += ks[(r4+3)%5] + r4;
+            }
+        }
+    };
+
     struct _roundapplyer{
         domain_type& c;
         Uint* ks;
@@ -248,6 +321,149 @@ protected:
 };
 
 
+// threefry<N, Uint, R, Constants, true> - the same functions, with
+// the key schedule cached.  sk[s] is the subkey that's injected after
+// round 4*s-1 (sk[0] is added to the counter before the first round),
+// with the injection number already added to its last word.  They're
+// derived from the plain threefry's, which is a private base, so that
+// the plain setkey can't be called behind the cache's back.  The key,
+// equality and batch operator() are re-exposed.  The multi-lane
+// kernels work out the key schedule once per batch, so they use the
+// plain key.
+template<unsigned N, typename Uint, unsigned R, typename Constants>
+struct threefry_cached_base : private threefry<N, Uint, R, Constants, false>{
+    typedef threefry<N, Uint, R, Constants, false> plain_type;
+    typedef typename plain_type::domain_type domain_type;
+    typedef typename plain_type::range_type range_type;
+    typedef typename plain_type::key_type key_type;
+
+    threefry_cached_base() : plain_type() { schedule(); }
+    threefry_cached_base(key_type _k) : plain_type(_k) { schedule(); }
+
+    void setkey(key_type _k){
+        plain_type::setkey(_k);
+        schedule();
+    }
+
+    using plain_type::getkey;
+
+    bool operator==(const threefry_cached_base& rhs) const{
+        return getkey() == rhs.getkey();
+    }
+
+    bool operator!=(const threefry_cached_base& rhs) const{
+        return getkey() != rhs.getkey();
+    }
+
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        plain_type::operator()(in, out, n);
+    }
+
+protected:
+    BOOST_STATIC_CONSTANT(unsigned, Nsubkeys = R/4+1);
+    Uint sk[Nsubkeys][N];
+
+    void schedule(){
+        Uint ks[N+1];
+        ks[N] = Constants::KS_PARITY;
+        for(unsigned j=0; j<N; ++j){
+            ks[j] = this->k[j];
+            ks[N] ^= this->k[j];
+        }
+        for(unsigned s=0; s<Nsubkeys; ++s){
+            for(unsigned j=0; j<N; ++j)
+                sk[s][j] = ks[(s+j)%(N+1)];
+            sk[s][N-1] += s;
+        }
+    }
+};
+
+template<typename Uint, unsigned R, typename Constants>
+struct threefry<2, Uint, R, Constants, true> : public threefry_cached_base<2, Uint, R, Constants>{
+    typedef threefry_cached_base<2, Uint, R, Constants> base_type;
+    typedef typename base_type::domain_type domain_type;
+    typedef typename base_type::range_type range_type;
+    typedef typename base_type::key_type key_type;
+
+    threefry() : base_type() {}
+    threefry(key_type _k) : base_type(_k) {}
+
+    range_type operator()(domain_type c) const{
+        c[0] += this->sk[0][0];
+        c[1] += this->sk[0][1];
+        _rounds rs(c, this->sk);
+        detail::unroll<R>::apply(rs);
+        return c;
+    }
+
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        base_type::operator()(in, out, n);
+    }
+
+protected:
+    struct _rounds{
+        domain_type& c;
+        const Uint (*sk)[2];
+        _rounds(domain_type& _c, const Uint (*_sk)[2]) : c(_c), sk(_sk){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            c[0] += c[1]; c[1] = detail::rotl(c[1],Constants::Rotations[r%8]); c[1] ^= c[0];
+            if(((r+1)&3)==0){
+                c[0] += sk[(r+1)>>2][0];
+                c[1] += sk[(r+1)>>2][1];
+            }
+        }
+    };
+};
+
+template<typename Uint, unsigned R, typename Constants>
+struct threefry<4, Uint, R, Constants, true> : public threefry_cached_base<4, Uint, R, Constants>{
+    typedef threefry_cached_base<4, Uint, R, Constants> base_type;
+    typedef typename base_type::domain_type domain_type;
+    typedef typename base_type::range_type range_type;
+    typedef typename base_type::key_type key_type;
+
+    threefry() : base_type() {}
+    threefry(key_type _k) : base_type(_k) {}
+
+    range_type operator()(domain_type c) const{
+        c[0] += this->sk[0][0];
+        c[1] += this->sk[0][1];
+        c[2] += this->sk[0][2];
+        c[3] += this->sk[0][3];
+        _rounds rs(c, this->sk);
+        detail::unroll<R>::apply(rs);
+        return c;
+    }
+
+    void operator()(const domain_type* in, range_type* out, std::size_t n) const{
+        base_type::operator()(in, out, n);
+    }
+
+protected:
+    struct _rounds{
+        domain_type& c;
+        const Uint (*sk)[4];
+        _rounds(domain_type& _c, const Uint (*_sk)[4]) : c(_c), sk(_sk){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            if((r&1)==0){
+                c[0] += c[1]; c[1] = detail::rotl(c[1],Constants::Rotations0[r%8]); c[1] ^= c[0];
+                c[2] += c[3]; c[3] = detail::rotl(c[3],Constants::Rotations1[r%8]); c[3] ^= c[2];
+            }else{
+                c[0] += c[3]; c[3] = detail::rotl(c[3],Constants::Rotations0[r%8]); c[3] ^= c[0];
+                c[2] += c[1]; c[1] = detail::rotl(c[1],Constants::Rotations1[r%8]); c[1] ^= c[2];
+            }
+            if(((r+1)&3)==0){
+                c[0] += sk[(r+1)>>2][0];
+                c[1] += sk[(r+1)>>2][1];
+                c[2] += sk[(r+1)>>2][2];
+                c[3] += sk[(r+1)>>2][3];
+            }
+        }
+    };
+};
+
 } // namespace random
 } // namespace boost
 
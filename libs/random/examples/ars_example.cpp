@@ -4,99 +4,22 @@
 // (See accompanying file LICENSE_1_0.txt or copy at
 // http://www.boost.org/LICENSE_1_0.txt )
 
-#include "m128_traits.hpp"
+#include <boost/random/ars.hpp>
 #include <boost/random/counter_based_engine.hpp>
 #include <boost/timer.hpp>
 #include <iostream>
 
 using namespace boost::random;
 
-// This is the ARS pseudo-random function from Salmon et al. 2011,
-// implemented using the AESNI _mm_aesenc_si128 hardware intrinsics.
-// On Intel hardware with the AESNI instructions, it's the fastest
-// Crush-resistant RNG we know of.  It runs at 2.7nsec/uint64 
-// on a 3.07GHz Xeon, i.e., just about 1 cycle-per-byte.
+// The ARS pseudo-random function from Salmon et al. 2011 (see
+// boost/random/ars.hpp).  On Intel hardware with the AESNI
+// instructions, it's the fastest Crush-resistant RNG we know of.  It
+// runs at 2.7nsec/uint64 on a 3.07GHz Xeon, i.e., just about 1
+// cycle-per-byte.  ars_prf checks for AESNI at run-time, so this
+// example doesn't need -maes, and it still runs (slowly) without it.
 //
-// This is in examples/ rather than boost/random because these
-// intrinsics (_mm_aesenc_si128) and data types (__m128i) are too
-// machine/compiler-specific for the main 'boost' tree.  Nevertheless,
-// this example demonstrates that it's possible (and not that hard) to
-// create hardware-dependent Prfs  that can be used by the standard
-// counter_based_engine.
-template <unsigned R=7>
-struct ars_prf{
-    typedef __m128i domain_type;
-    typedef __m128i range_type;
-    typedef __m128i key_type ;
-
-    range_type operator()(domain_type v){
-        __m128i kweyl = _mm_set_epi64x(UINT64_C(0xBB67AE8584CAA73B), /* sqrt(3) - 1.0 */
-                                       UINT64_C(0x9E3779B97F4A7C15)); /* golden ratio */
-        __m128i kk = k;
-        if( R>1 ){
-            kk = _mm_add_epi64(kk, kweyl);
-            v = _mm_aesenc_si128(v, kk);
-        }
-        if( R>2 ){
-            kk = _mm_add_epi64(kk, kweyl);
-            v = _mm_aesenc_si128(v, kk);
-        }
-        if( R>3 ){
-            kk = _mm_add_epi64(kk, kweyl);
-            v = _mm_aesenc_si128(v, kk);
-        }
-        if( R>4 ){
-            kk = _mm_add_epi64(kk, kweyl);
-            v = _mm_aesenc_si128(v, kk);
-        }
-        if( R>5 ){
-            kk = _mm_add_epi64(kk, kweyl);
-            v = _mm_aesenc_si128(v, kk);
-        }
-        if( R>6 ){
-            kk = _mm_add_epi64(kk, kweyl);
-            v = _mm_aesenc_si128(v, kk);
-        }
-        if( R>7 ){
-            kk = _mm_add_epi64(kk, kweyl);
-            v = _mm_aesenc_si128(v, kk);
-        }
-        if( R>8 ){
-            kk = _mm_add_epi64(kk, kweyl);
-            v = _mm_aesenc_si128(v, kk);
-        }
-        if( R>9 ){
-            kk = _mm_add_epi64(kk, kweyl);
-            v = _mm_aesenc_si128(v, kk);
-        }
-        kk = _mm_add_epi64(kk, kweyl);
-        v = _mm_aesenclast_si128(v, kk);
-        return v;
-    }
-
-    ars_prf(key_type _k) : k(_k){
-        //std::cerr << "ars_prf(key_type)\n";
-    }
-
-    ars_prf() { k = key_type(); }
-
-    ars_prf(const ars_prf& v) : k(v.k) {
-        //std::cerr << "ars_prf(const ars_prf&)\n";
-    }
-
-    void setkey(key_type _k){ k = _k; }
-    key_type getkey() const { return k; }
-
-    bool operator==(const ars_prf& rhs) const{
-        return boost::random::detail::counter_traits<__m128i>::is_equal(k, rhs.k);
-    }
-
-    bool operator!=(const ars_prf& rhs) const{
-        return !(k == rhs.k);
-    }
-protected:
-    key_type k;
-};
+// m128_traits.hpp shows how to use a hardware-dependent type like
+// __m128i as a Prf's domain_type.
 
 static const double cpu_frequency = 3.07e9;
 
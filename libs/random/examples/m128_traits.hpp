@@ -154,7 +154,7 @@ public:
     }
 
     template<unsigned w>
-    static std::size_t size(){
+    BOOST_RANDOM_DETAIL_CONSTEXPR static std::size_t size(){
         BOOST_STATIC_ASSERT(w==32 || w==64);
         return 128/w;
     }
@@ -0,0 +1,167 @@
+/* mulhilo_speed.cpp - compare the 64-bit mulhilo policies in
+ * detail/mulhilo.hpp inside philox2x64 and philox4x64.
+ *
+ * Copyright D. E. Shaw Research, 2014
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <boost/config.hpp>
+#include <boost/progress.hpp>
+#include <boost/random/philox.hpp>
+#include <boost/random/detail/mulhilo.hpp>
+#include <boost/random/detail/unroll.hpp>
+
+// set to your CPU frequency
+static const double cpu_frequency = 3.07 * 1e9;
+
+using namespace boost::random;
+using namespace boost::random::detail;
+
+void show_elapsed(double end, int iter, const std::string & name, size_t bytes_per_iter)
+{
+  double usec = end/iter*1e6;
+  double cycles = usec * cpu_frequency/1e6;
+  std::cout << name << ": "
+            << usec*1e3 << " nsec/loop = "
+            << cycles << " CPU cycles = "
+            << cycles/bytes_per_iter << " CPB"
+            << std::endl;
+}
+
+// policy_philox - the rounds of philox<N, uint64_t, R>, exactly as in
+// philox.hpp, but with the multiplies done by the given mulhilo
+// Policy rather than by mulhilo64_policy.
+template <unsigned N, unsigned R, typename Policy>
+struct policy_philox;
+
+template <unsigned R, typename Policy>
+struct policy_philox<2, R, Policy>{
+    typedef philox<2, uint64_t, R> prf_type;
+    typedef typename prf_type::domain_type domain_type;
+    typedef typename prf_type::key_type key_type;
+    typedef philox_constants<2, uint64_t> Constants;
+
+    explicit policy_philox(key_type _k) : k(_k){}
+
+    domain_type operator()(domain_type c) const{
+        key_type kcopy = k;
+        rounds ra(c, kcopy);
+        unroll<R>::apply(ra);
+        return c;
+    }
+
+    struct rounds{
+        domain_type& c;
+        key_type& k;
+        rounds(domain_type& _c, key_type& _k) : c(_c), k(_k){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            uint64_t hi;
+            uint64_t lo = Policy::apply(Constants::M0, c[0], hi);
+            domain_type out = {{hi^k[0]^c[1], lo}};
+            c = out;
+            k[0] += Constants::W0;
+        }
+    };
+    key_type k;
+};
+
+template <unsigned R, typename Policy>
+struct policy_philox<4, R, Policy>{
+    typedef philox<4, uint64_t, R> prf_type;
+    typedef typename prf_type::domain_type domain_type;
+    typedef typename prf_type::key_type key_type;
+    typedef philox_constants<4, uint64_t> Constants;
+
+    explicit policy_philox(key_type _k) : k(_k){}
+
+    domain_type operator()(domain_type c) const{
+        key_type kcopy = k;
+        rounds ra(c, kcopy);
+        unroll<R>::apply(ra);
+        return c;
+    }
+
+    struct rounds{
+        domain_type& c;
+        key_type& k;
+        rounds(domain_type& _c, key_type& _k) : c(_c), k(_k){}
+        template <unsigned r>
+        BOOST_FORCEINLINE void round(){
+            uint64_t hi0, hi1;
+            uint64_t lo0 = Policy::apply(Constants::M0, c[0], hi0);
+            uint64_t lo1 = Policy::apply(Constants::M1, c[2], hi1);
+            domain_type out = {{hi1^c[1]^k[0], lo1, hi0^c[3]^k[1], lo0}};
+            c = out;
+            k[0] += Constants::W0;
+            k[1] += Constants::W1;
+        }
+    };
+    key_type k;
+};
+
+// run_policy - time iter evaluations of philox<N, uint64_t, R> in
+// counter mode, after checking that the rounds above really are
+// philox's.
+template <unsigned N, unsigned R, typename Policy>
+void  __attribute__((noinline)) run_policy(const std::string& name, int iter){
+    typedef policy_philox<N, R, Policy> prf_t;
+    typedef typename prf_t::domain_type domain_type;
+    typedef typename prf_t::key_type key_type;
+    key_type k = {{}};
+    k[0] = iter&0xffffff;
+    prf_t prf(k);
+    domain_type c = {{}};
+    c[1] = 12345;
+    if( prf(c) != typename prf_t::prf_type(k)(c) ){
+        std::cerr << name << ": doesn't match philox!\n";
+        std::exit(1);
+    }
+    uint64_t tmp = 0;
+    boost::timer t;
+    for(int i = 0; i < iter; ++i){
+        c[0] = i;
+        domain_type r = prf(c);
+        tmp ^= r[0] ^ r[N-1];
+    }
+    show_elapsed(t.elapsed(), iter, name, sizeof(domain_type));
+    if(tmp==0)
+        std::cerr << name << ": The xor is zero.  That's surprising!\n";
+}
+
+template <unsigned N, unsigned R>
+void do_philox(const std::string& name, int iter){
+  std::cout << name << ":\n";
+  run_policy<N, R, mulhilo_halfword_policy>(name + " halfword", iter);
+#if defined(BOOST_RANDOM_HAVE_MULHILO_MULQ)
+  run_policy<N, R, mulhilo_mulq_policy>(name + " mulq", iter);
+#endif
+#if defined(BOOST_RANDOM_HAVE_MULHILO_INT128)
+  run_policy<N, R, mulhilo_int128_policy>(name + " int128", iter);
+#endif
+#if defined(BOOST_RANDOM_HAVE_MULHILO_MULX)
+  run_policy<N, R, mulhilo_mulx_policy>(name + " mulx", iter);
+#else
+  std::cout << "(no BMI2 - compile with -mbmi2 or a -march that has it for mulx)\n";
+#endif
+  run_policy<N, R, mulhilo64_policy>(name + " default", iter);
+}
+
+int main(int argc, char*argv[])
+{
+  if(argc != 2) {
+    std::cerr << "usage: " << argv[0] << " iterations" << std::endl;
+    return 1;
+  }
+  int iter = std::atoi(argv[1]);
+
+  do_philox<2, 10>("philox2x64", iter);
+  do_philox<4, 10>("philox4x64", iter);
+  do_philox<4, 7>("philox4x64-7", iter);
+  return 0;
+}
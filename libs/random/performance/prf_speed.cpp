@@ -18,7 +18,14 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/random/philox.hpp>
 #include <boost/random/threefry.hpp>
+#include <boost/random/sha1_prf.hpp>
+#include <boost/random/ars.hpp>
+#include <boost/random/aes_prf.hpp>
 #include <boost/random/counter_based_engine.hpp>
+#include <boost/random/buffered_counter_based_engine.hpp>
+#include <boost/random/fill_uniform01.hpp>
+#include <boost/random/fill_normal.hpp>
+#include <boost/random/detail/cpu_features.hpp>
 
 /*
  * Configuration Section
@@ -67,7 +74,7 @@ struct IdentityPrf{
     IdentityPrf(key_type){}
     IdentityPrf(UINT){}
 
-    range_type operator()(domain_type c){ return c; }
+    range_type operator()(domain_type c) const{ return c; }
 };
 
 // start implementation of measuring timing
@@ -110,16 +117,183 @@ void  __attribute__((noinline)) run_cbeng(const std::string& name, int iter){
     run(iter, pfx, counter_based_engine<Otype, Prf>(iter&0xffffff));
 }
 
+template <typename Otype, typename Prf>
+void  __attribute__((noinline)) run_bufeng(const std::string& name, int iter){
+    std::string pfx= "buffered_counter_based_engine<" + name + ">";
+    run(iter, pfx, buffered_counter_based_engine<Otype, Prf>(iter&0xffffff));
+}
+
+// run_prf - time the Prf by itself, without a counter_based_engine,
+// evaluating blocks of Nbatch counters either one at a time with
+// operator()(domain_type) or all at once with the batch
+// operator()(const domain_type*, range_type*, size_t), which may use
+// multi-lane SIMD kernels.
+template <typename Prf>
+void  __attribute__((noinline)) run_prf(const std::string& name, int iter){
+    typedef typename Prf::domain_type domain_type;
+    typedef typename Prf::range_type range_type;
+    static const int Nbatch = 64;
+    domain_type in[Nbatch];
+    range_type out[Nbatch];
+    typename Prf::key_type k = {{}};
+    k[0] = iter&0xffffff;
+    Prf prf(k);
+    for(int j=0; j<Nbatch; ++j){
+        in[j] = domain_type();
+        in[j][0] = j;
+    }
+    typename range_type::value_type tmp = 0;
+    boost::timer t;
+    for(int i = 0; i < iter; i += Nbatch){
+        for(int j=0; j<Nbatch; ++j)
+            out[j] = prf(in[j]);
+        for(int j=0; j<Nbatch; ++j){
+            tmp ^= out[j][0];
+            in[j][0] += Nbatch;
+        }
+    }
+    show_elapsed(t.elapsed(), iter, name + " scalar", sizeof(range_type));
+
+    t.restart();
+    for(int i = 0; i < iter; i += Nbatch){
+        prf(in, out, Nbatch);
+        for(int j=0; j<Nbatch; ++j){
+            tmp ^= out[j][0];
+            in[j][0] += Nbatch;
+        }
+    }
+    show_elapsed(t.elapsed(), iter, name + " batch", sizeof(range_type));
+    if(tmp==0)
+        std::cerr << name << ": The xor is zero.  That's surprising!\n";
+}
+
+// run_u01 - time uniform Real values in [0, 1), one at a time from
+// uniform_01, and Nbatch at a time from fill_uniform01.
+template <typename Real, typename Otype, typename Prf>
+void  __attribute__((noinline)) run_u01(const std::string& name, int iter){
+    static const int Nbatch = 1024;
+    Real out[Nbatch];
+    Real tmp = 0;
+    counter_based_engine<Otype, Prf> eng(iter&0xffffff);
+    uniform_01<Real> u01;
+    boost::timer t;
+    for(int i = 0; i < iter; ++i)
+        tmp += u01(eng);
+    show_elapsed(t.elapsed(), iter, name + " uniform_01", sizeof(Real));
+
+    t.restart();
+    for(int i = 0; i < iter; i += Nbatch){
+        fill_uniform01(eng, out, Nbatch);
+        for(int j=0; j<Nbatch; ++j)
+            tmp += out[j];
+    }
+    show_elapsed(t.elapsed(), iter, name + " fill_uniform01", sizeof(Real));
+    if(tmp==0)
+        std::cerr << name << ": The sum is zero.  That's surprising!\n";
+}
+
+// run_normal - likewise, for normal_distribution and fill_normal.
+template <typename Real, typename Otype, typename Prf>
+void  __attribute__((noinline)) run_normal(const std::string& name, int iter){
+    static const int Nbatch = 1024;
+    Real out[Nbatch];
+    Real tmp = 0;
+    counter_based_engine<Otype, Prf> eng(iter&0xffffff);
+    normal_distribution<Real> nd;
+    boost::timer t;
+    for(int i = 0; i < iter; ++i)
+        tmp += nd(eng);
+    show_elapsed(t.elapsed(), iter, name + " normal_distribution", sizeof(Real));
+
+    t.restart();
+    for(int i = 0; i < iter; i += Nbatch){
+        fill_normal(eng, out, Nbatch);
+        for(int j=0; j<Nbatch; ++j)
+            tmp += out[j];
+    }
+    show_elapsed(t.elapsed(), iter, name + " fill_normal", sizeof(Real));
+    if(tmp==0)
+        std::cerr << name << ": The sum is zero.  That's surprising!\n";
+}
+
+// run_restart - time the restart-bound pattern in
+// counter_based_example.cpp's thermalize and assignmasses:  a
+// restart for each item, followed by just N draws.  The times are
+// per restart, i.e., per N values.
+template <unsigned N, typename Otype, typename Prf>
+void  __attribute__((noinline)) run_restart(const std::string& name, int iter){
+    typedef counter_based_engine<Otype, Prf> eng_t;
+    typedef typename eng_t::domain_type domain_type;
+    std::string pfx = "counter_based_engine<" + name + ">";
+    eng_t eng(iter&0xffffff);
+    domain_type base = eng_t::domain_traits::make_counter();
+    Otype r[N];
+    Otype tmp = 0;
+    boost::timer t;
+    for(int i = 0; i < iter; ++i){
+        base[0] = i;
+        eng.restart(base);
+        for(unsigned j=0; j<N; ++j)
+            tmp ^= eng();
+    }
+    show_elapsed(t.elapsed(), iter, pfx + " restart", N*sizeof(Otype));
+
+    t.restart();
+    for(int i = 0; i < iter; ++i){
+        base[0] = i;
+        eng.restart_unchecked(base);
+        for(unsigned j=0; j<N; ++j)
+            tmp ^= eng();
+    }
+    show_elapsed(t.elapsed(), iter, pfx + " restart_unchecked", N*sizeof(Otype));
+
+    t.restart();
+    for(int i = 0; i < iter; ++i){
+        base[0] = i;
+        eng.template restart_and_draw<N>(base, r);
+        for(unsigned j=0; j<N; ++j)
+            tmp ^= r[j];
+    }
+    show_elapsed(t.elapsed(), iter, pfx + " restart_and_draw", N*sizeof(Otype));
+    if(tmp==0)
+        std::cerr << name << ": The xor is zero.  That's surprising!\n";
+}
+
+void do_restart(int iter){
+  std::cout << "Restart, then draw 1 or 3 values:  times are per restart\n";
+  run_restart<1, uint32_t, philox<4, uint32_t> >("philox4x32", iter);
+  run_restart<3, uint32_t, philox<4, uint32_t> >("philox4x32", iter);
+  run_restart<3, uint64_t, philox<2, uint64_t> >("philox2x64", iter);
+  run_restart<3, uint32_t, threefry<2, uint64_t> >("threefry2x64/32", iter);
+  run_restart<3, uint64_t, threefry<4, uint64_t> >("threefry4x64", iter);
+}
+
+void do_normal(int iter){
+  std::cout << "Normal:  one at a time vs. fill_normal\n";
+  run_normal<float, uint32_t, philox<4, uint32_t> >("float/philox4x32", iter);
+  run_normal<double, uint64_t, philox<4, uint64_t> >("double/philox4x64", iter);
+}
+
+void do_uniform01(int iter){
+  std::cout << "Uniform [0, 1):  one at a time vs. fill_uniform01\n";
+  run_u01<float, uint32_t, philox<4, uint32_t> >("float/philox4x32", iter);
+  run_u01<double, uint64_t, philox<4, uint64_t> >("double/philox4x64", iter);
+  run_u01<double, uint64_t, threefry<4, uint64_t> >("double/threefry4x64", iter);
+}
+
 void do_threefry(int iter){
-  // WARNING - if we include the 2x32 tests, then gcc-4.8 reports
-  // *much lower* (3x) performance for some of the other functions.
-  // Wild guess - we've hit some limit meant to prevent too much
+  // N.B.  When the rounds were unrolled with mpl::for_each, including
+  // the 2x32 tests made gcc-4.8 report *much lower* (3x) performance
+  // for some of the other functions - presumably we'd hit some limit
+  // meant to prevent too much inlining.  Now that detail::unroll
+  // forces the issue, they're back.  Compare with prf_speed_rolled
+  // (see the Makefile) to see what the unrolling is worth.
   std::cout << "Threefry: with recommended safety margin\n";
-  //run_cbeng<uint64_t, threefry<4, uint64_t> >("threefry4x64", iter);
-  //run_cbeng<uint32_t, threefry<4, uint64_t> >("threfry4x64/32", iter);
-  //run_cbeng<uint32_t, threefry<2, uint32_t> >("threefry2x32", iter);
-  //run_cbeng<uint32_t, threefry<4, uint32_t> >("threefry4x32", iter);
-  //run_cbeng<uint64_t, threefry<2, uint64_t> >("threefry2x64", iter);
+  run_cbeng<uint64_t, threefry<4, uint64_t> >("threefry4x64", iter);
+  run_cbeng<uint32_t, threefry<4, uint64_t> >("threefry4x64/32", iter);
+  run_cbeng<uint32_t, threefry<2, uint32_t> >("threefry2x32", iter);
+  run_cbeng<uint32_t, threefry<4, uint32_t> >("threefry4x32", iter);
+  run_cbeng<uint64_t, threefry<2, uint64_t> >("threefry2x64", iter);
 
   std::cout << "Threefry:  Crush-resistant, with no safety margin\n";
   // Note - on a 3.07GHz Xeon 5667 (Westmere) threefry4x64-12 should
@@ -130,6 +304,22 @@ void do_threefry(int iter){
   //run_cbeng<threefry<4, uint32_t, 12> >("threefry4x32-12", iter);
   //run_cbeng<threefry<2, uint64_t, 13> >("threefry2x64-13", iter);
   //run_cbeng<threefry<2, uint32_t, 13> >("threefry2x32-13", iter);
+
+  std::cout << "Threefry:  Prf only, scalar vs. batch\n";
+  run_prf<threefry<4, uint64_t> >("threefry4x64", iter);
+  run_prf<threefry<4, uint64_t, 12> >("threefry4x64-12", iter);
+  run_prf<threefry<2, uint64_t> >("threefry2x64", iter);
+  run_prf<threefry<2, uint64_t, 13> >("threefry2x64-13", iter);
+
+  std::cout << "Threefry:  one value at a time, buffered\n";
+  run_bufeng<uint64_t, threefry<4, uint64_t, 12> >("threefry4x64-12", iter);
+  run_bufeng<uint32_t, threefry<4, uint64_t, 12> >("threefry4x64-12/32", iter);
+
+  std::cout << "Threefry:  cached key schedule\n";
+  run_cbeng<uint64_t, threefry<4, uint64_t, 20, threefry_constants<4, uint64_t>, true> >("threefry4x64", iter);
+  run_cbeng<uint64_t, threefry<4, uint64_t, 12, threefry_constants<4, uint64_t>, true> >("threefry4x64-12", iter);
+  run_cbeng<uint64_t, threefry<2, uint64_t, 20, threefry_constants<2, uint64_t>, true> >("threefry2x64", iter);
+  run_cbeng<uint32_t, threefry<4, uint32_t, 20, threefry_constants<4, uint32_t>, true> >("threefry4x32", iter);
 }
 
 void do_philox(int iter){
@@ -144,6 +334,46 @@ void do_philox(int iter){
   run_cbeng<uint32_t, philox<4, uint32_t, 7> >("philox4x32-7", iter);
   run_cbeng<uint64_t, philox<2, uint64_t, 6> >("philox2x64-6", iter);
   run_cbeng<uint32_t, philox<2, uint32_t, 7> >("philox2x32-7", iter);
+
+  std::cout << "Philox:  Prf only, scalar vs. batch\n";
+  run_prf<philox<4, uint32_t> >("philox4x32", iter);
+  run_prf<philox<4, uint32_t, 7> >("philox4x32-7", iter);
+  run_prf<philox<4, uint64_t> >("philox4x64", iter);
+  run_prf<philox<4, uint64_t, 7> >("philox4x64-7", iter);
+  run_prf<philox<2, uint64_t> >("philox2x64", iter);
+
+  std::cout << "Philox:  one value at a time, buffered\n";
+  run_bufeng<uint64_t, philox<4, uint64_t> >("philox4x64", iter);
+  run_bufeng<uint32_t, philox<4, uint32_t> >("philox4x32", iter);
+  run_bufeng<uint64_t, philox<2, uint64_t> >("philox2x64", iter);
+  run_bufeng<uint32_t, philox<2, uint32_t> >("philox2x32", iter);
+
+  std::cout << "Philox:  cached key schedule\n";
+  run_cbeng<uint64_t, philox<4, uint64_t, 10, philox_constants<4, uint64_t>, true> >("philox4x64", iter);
+  run_cbeng<uint32_t, philox<4, uint32_t, 10, philox_constants<4, uint32_t>, true> >("philox4x32", iter);
+  run_cbeng<uint64_t, philox<2, uint64_t, 10, philox_constants<2, uint64_t>, true> >("philox2x64", iter);
+  run_cbeng<uint32_t, philox<2, uint32_t, 10, philox_constants<2, uint32_t>, true> >("philox2x32", iter);
+}
+
+void do_sha1(int iter){
+  std::cout << "SHA-1:  cryptographic quality\n";
+  run_cbeng<uint32_t, sha1_prf<> >("sha1<>", iter);
+  run_prf<sha1_prf<> >("sha1<>", iter);
+  std::cout << "SHA-1:  Version 2, with the key rounds cached\n";
+  run_cbeng<uint32_t, sha1_prf<4, 2, 2> >("sha1<4,2,2>", iter);
+  run_prf<sha1_prf<4, 2, 2> >("sha1<4,2,2>", iter);
+}
+
+void do_ars(int iter){
+  std::cout << "ARS:  AES-NI if the CPU has it\n";
+  run_cbeng<uint64_t, ars_prf<> >("ars", iter);
+  run_cbeng<uint64_t, ars_prf<5> >("ars-5", iter);
+}
+
+void do_aes(int iter){
+  std::cout << "AES-128:  AES-NI if the CPU has it\n";
+  run_cbeng<uint64_t, aes_prf>("aes", iter);
+  run_prf<aes_prf>("aes", iter);
 }
 
 int main(int argc, char*argv[])
@@ -160,11 +390,21 @@ int main(int argc, char*argv[])
 #endif
     atoi(argv[1]);
 
+  // The batch kernels are chosen at run time (BOOST_RANDOM_SIMD can
+  // lower the level), so say which ones these numbers are for.
+  static const char* const levels[] = {"scalar", "sse4.1", "avx2", "avx512"};
+  std::cout << "SIMD level: " << levels[boost::random::detail::cpu_simd_level()] << '\n';
   std::cout << "\nPseudo-random functions:\n";
   //run_cbeng<uint64_t, IdentityPrf<2, uint64_t> >("Ident2x64", iter);
 
   do_threefry(iter);
   do_philox(iter);
+  do_sha1(iter);
+  do_ars(iter);
+  do_aes(iter);
+  do_uniform01(iter);
+  do_normal(iter);
+  do_restart(iter);
   
   return 0;
 }
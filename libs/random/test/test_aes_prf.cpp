@@ -0,0 +1,123 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#include <boost/random/aes_prf.hpp>
+#include <boost/random/counter_based_engine.hpp>
+#include <boost/random/detail/prf_batch.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/cstdint.hpp>
+#include <cstdio>
+#include <vector>
+
+#include "test_kat.hpp"
+
+using boost::random::aes_prf;
+using boost::random::detail::aes_block;
+
+using boost::random::test::RandomNumberFunctor;
+BOOST_CONCEPT_ASSERT((RandomNumberFunctor< aes_prf >));
+
+// aes_prf's batch operator() is found by has_batch_operator, so
+// counter_based_engine::fill will use it.
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator<aes_prf>::value);
+
+// bytes - a block from its sixteen bytes, in the order FIPS-197
+// prints them.
+aes_block bytes(const char* hex){
+    aes_block b = {{0, 0}};
+    for(unsigned i=0; i<16; ++i){
+        unsigned byte;
+        std::sscanf(hex+2*i, "%2x", &byte);
+        b[i/8] |= uint64_t(byte) << (8*(i%8));
+    }
+    return b;
+}
+
+void doaes_kat(const char* key, const char* plaintext, const char* ciphertext){
+    aes_prf prf(bytes(key));
+    BOOST_CHECK_EQUAL(prf(bytes(plaintext)), bytes(ciphertext));
+    aes_prf::schedule_type s;
+    aes_prf::portable_expand(bytes(key), s);
+    BOOST_CHECK_EQUAL(aes_prf::portable_apply(s, bytes(plaintext)), bytes(ciphertext));
+}
+
+// FIPS-197, Appendices B and C.1, and the counter-mode example in
+// NIST SP 800-38A, F.5.1.
+BOOST_AUTO_TEST_CASE(test_kat_aes)
+{
+    doaes_kat("2b7e151628aed2a6abf7158809cf4f3c", "3243f6a8885a308d313198a2e0370734", "3925841d02dc09fbdc118597196a0b32");
+    doaes_kat("000102030405060708090a0b0c0d0e0f", "00112233445566778899aabbccddeeff", "69c4e0d86a7b0430d8cdb78070b4c55a");
+    doaes_kat("2b7e151628aed2a6abf7158809cf4f3c", "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff", "ec8cdf7398607cb0f2d21675ea9ea1e4");
+    doaes_kat("2b7e151628aed2a6abf7158809cf4f3c", "f0f1f2f3f4f5f6f7f8f9fafbfcfdff00", "362b7c3c6773516318a077d7fc5073ae");
+    doaes_kat("2b7e151628aed2a6abf7158809cf4f3c", "f0f1f2f3f4f5f6f7f8f9fafbfcfdff01", "6a2cc3787889374fbeb4c81b17ba6c44");
+    doaes_kat("2b7e151628aed2a6abf7158809cf4f3c", "f0f1f2f3f4f5f6f7f8f9fafbfcfdff02", "e89c399ff0f198c6d40a31db156cabfe");
+}
+
+// The key expansion example in FIPS-197, Appendix A.1.
+BOOST_AUTO_TEST_CASE(test_aes_expand)
+{
+    aes_prf::schedule_type s;
+    aes_prf::portable_expand(bytes("2b7e151628aed2a6abf7158809cf4f3c"), s);
+    BOOST_CHECK_EQUAL(s[1], bytes("a0fafe1788542cb123a339392a6c7605"));
+    BOOST_CHECK_EQUAL(s[10], bytes("d014f9a8c9ee2589e13f0cc8b6630ca6"));
+}
+
+// The portable key expansion and rounds must agree with AES-NI.
+BOOST_AUTO_TEST_CASE(test_aes_portable)
+{
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+    if( !boost::random::detail::aes_has_aesni() ){
+        BOOST_TEST_MESSAGE("no AES-NI on this CPU - not comparing aes_prf's portable code with it");
+        return;
+    }
+    boost::random::mt19937_64 mt;
+    for(unsigned i=0; i<1000; ++i){
+        aes_prf::key_type k = {{mt(), mt()}};
+        aes_prf::schedule_type s, sni;
+        aes_prf::portable_expand(k, s);
+        aes_prf::aesni_expand(k, sni);
+        BOOST_CHECK(s == sni);
+        for(unsigned j=0; j<10; ++j){
+            aes_prf::domain_type c = {{mt(), mt()}};
+            BOOST_CHECK_EQUAL(aes_prf::portable_apply(s, c), aes_prf::aesni_apply(s, c));
+        }
+    }
+#endif
+}
+
+// The batch operator() must agree with operator(), whatever the
+// number of counters and however they line up with the 8- and 16-block
+// kernels.
+BOOST_AUTO_TEST_CASE(test_aes_batch)
+{
+    boost::random::mt19937_64 mt;
+    aes_prf::key_type k = {{mt(), mt()}};
+    aes_prf prf(k);
+    std::vector<aes_prf::domain_type> in(71);
+    for(size_t i=0; i<in.size(); ++i){
+        in[i][0] = mt();
+        in[i][1] = mt();
+    }
+    for(size_t n=0; n<=in.size(); n+=(n<40 ? 1 : 31)){
+        std::vector<aes_prf::range_type> out(n);
+        prf(n ? &in[0] : 0, n ? &out[0] : 0, n);
+        for(size_t i=0; i<n; ++i)
+            BOOST_CHECK_EQUAL(out[i], prf(in[i]));
+    }
+}
+
+// counter_based_engine::fill goes through the batch operator().  It
+// must produce the same sequence as operator()().
+BOOST_AUTO_TEST_CASE(test_aes_engine)
+{
+    typedef boost::random::counter_based_engine<uint64_t, aes_prf> engine_t;
+    engine_t e1, e2;
+    std::vector<uint64_t> v(1000);
+    e1.fill(v.begin(), v.end());
+    for(size_t i=0; i<v.size(); ++i)
+        BOOST_CHECK_EQUAL(v[i], e2());
+    BOOST_CHECK(e1 == e2);
+}
@@ -0,0 +1,96 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#include <boost/random/ars.hpp>
+#include <boost/random/detail/aes_round.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/cstdint.hpp>
+#include <cstdio>
+
+#include "test_kat.hpp"
+
+using boost::random::ars_prf;
+using boost::random::detail::aes_block;
+
+using boost::random::test::RandomNumberFunctor;
+BOOST_CONCEPT_ASSERT((RandomNumberFunctor< ars_prf<> >));
+BOOST_CONCEPT_ASSERT((RandomNumberFunctor< ars_prf<5> >));
+
+// The known answers were computed with an __m128i ars_prf written
+// directly with the AES-NI intrinsics, with the low 64 bits of each
+// __m128i first.
+BOOST_AUTO_TEST_CASE(test_kat_ars)
+{
+    dokat<ars_prf<5> >("0000000000000000 0000000000000000 0000000000000000 0000000000000000   7cdc3bca7ecce06f 29d24c9b15513c87");
+    dokat<ars_prf<5> >("ffffffffffffffff ffffffffffffffff ffffffffffffffff ffffffffffffffff   fff6d55fddc35afd 5c0ab8e3d4479a33");
+    dokat<ars_prf<5> >("243f6a8885a308d3 13198a2e03707344 a4093822299f31d0 082efa98ec4e6c89   aa922993f78936f3 1be012aa6fc9976b");
+    dokat<ars_prf<7> >("0000000000000000 0000000000000000 0000000000000000 0000000000000000   c45798f3dacf61ff 101e27f3113c7eeb");
+    dokat<ars_prf<7> >("ffffffffffffffff ffffffffffffffff ffffffffffffffff ffffffffffffffff   6f8a3d47dd74ba12 01e3b0b8941d702e");
+    dokat<ars_prf<7> >("243f6a8885a308d3 13198a2e03707344 a4093822299f31d0 082efa98ec4e6c89   f7957ac57ec21ccf 13cfa3a2a04f813f");
+    dokat<ars_prf<10> >("0000000000000000 0000000000000000 0000000000000000 0000000000000000   506401ef8d73ee19 0cbe9c0d13c2dbe4");
+    dokat<ars_prf<10> >("ffffffffffffffff ffffffffffffffff ffffffffffffffff ffffffffffffffff   39ecfc8714c92d08 0bd184077aad373f");
+    dokat<ars_prf<10> >("243f6a8885a308d3 13198a2e03707344 a4093822299f31d0 082efa98ec4e6c89   1928e8450cb6f4d8 88e7434494854816");
+    dokat<ars_prf<1> >("243f6a8885a308d3 13198a2e03707344 a4093822299f31d0 082efa98ec4e6c89   d5943e1fd5b8af83 b8e3992f47136ddf");
+}
+
+// bytes - an AES state from its sixteen bytes, in the order FIPS-197
+// prints them.
+aes_block bytes(const char* hex){
+    aes_block b = {{0, 0}};
+    for(unsigned i=0; i<16; ++i){
+        unsigned byte;
+        std::sscanf(hex+2*i, "%2x", &byte);
+        b[i/8] |= uint64_t(byte) << (8*(i%8));
+    }
+    return b;
+}
+
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+BOOST_RANDOM_DETAIL_AESNI_TARGET
+aes_block aesenc(const aes_block& s, const aes_block& k){
+    using boost::random::detail::aes_load;
+    using boost::random::detail::aes_store;
+    return aes_store(_mm_aesenc_si128(aes_load(s), aes_load(k)));
+}
+#endif
+
+// Round 1 of the AES-128 example in FIPS-197, Appendix B.  (The last
+// round is checked against aesenclast by test_ars_portable.)
+BOOST_AUTO_TEST_CASE(test_aes_round_fips197)
+{
+    aes_block s1 = bytes("193de3bea0f4e22b9ac68d2ae9f84808");
+    aes_block k1 = bytes("a0fafe1788542cb123a339392a6c7605");
+    aes_block s2 = bytes("a49c7ff2689f352b6b5bea43026a5049");
+    BOOST_CHECK_EQUAL(boost::random::detail::aes_round(s1, k1), s2);
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+    if( boost::random::detail::aes_has_aesni() )
+        BOOST_CHECK_EQUAL(aesenc(s1, k1), s2);
+#endif
+}
+
+// The portable rounds must agree with AES-NI.
+template <unsigned R>
+void doars_portable(){
+#if defined(BOOST_RANDOM_HAVE_AESNI)
+    if( !boost::random::detail::aes_has_aesni() ){
+        BOOST_TEST_MESSAGE("no AES-NI on this CPU - not comparing ars_prf's portable rounds with it");
+        return;
+    }
+    boost::random::mt19937_64 mt;
+    for(unsigned i=0; i<10000; ++i){
+        typename ars_prf<R>::key_type k = {{mt(), mt()}};
+        typename ars_prf<R>::domain_type c = {{mt(), mt()}};
+        BOOST_CHECK_EQUAL(ars_prf<R>::portable_apply(k, c), ars_prf<R>::aesni_apply(k, c));
+    }
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(test_ars_portable)
+{
+    doars_portable<1>();
+    doars_portable<5>();
+    doars_portable<7>();
+    doars_portable<10>();
+}
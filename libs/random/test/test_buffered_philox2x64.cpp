@@ -0,0 +1,108 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#include <boost/random/philox.hpp>
+#include <boost/random/detail/simd_dispatch.hpp>
+#include <boost/cstdint.hpp>
+#include <sstream>
+
+// The same engine as test_philox2x64.cpp, but buffered.  It must
+// produce the same sequence, so the validation values are the same.
+#define BOOST_COUNTER_BASED_ENGINE_RESULT_TYPE uint64_t
+#define BOOST_PSEUDO_RANDOM_FUNCTION boost::random::philox<2, uint64_t>
+#define BOOST_COUNTER_BASED_ENGINE_CTRBITS 32
+#define BOOST_COUNTER_BASED_ENGINE_BUFFER_BLOCKS 5
+
+#define BOOST_RANDOM_SEED_WORDS 2
+
+#define BOOST_RANDOM_VALIDATION_VALUE UINT64_C(12548399570197440638)
+#define BOOST_RANDOM_SEED_SEQ_VALIDATION_VALUE UINT64_C(1950189153452696268)
+#define BOOST_RANDOM_ITERATOR_VALIDATION_VALUE UINT64_C(16632851287075411822)
+
+#define BOOST_RANDOM_GENERATE_VALUES { 2554582833,  3389038661, 3383248309, 1724006946 }
+#include "test_counter_based_engine.ipp"
+
+template <typename E>
+std::string to_string(const E& e){
+    std::ostringstream oss;
+    oss << e;
+    return oss.str();
+}
+
+// Put a buffered and an unbuffered engine through the same mix of
+// draws, discards, fills, copies, restarts and stream round trips,
+// checking that they always agree.
+BOOST_AUTO_TEST_CASE(test_buffered_vs_unbuffered)
+{
+    engine_t be;
+    unbuffered_engine_t ue;
+    BOOST_CHECK_EQUAL(to_string(be), to_string(ue));
+    const unsigned Nresult = engine_t::results_per_counter();
+    const unsigned Nbuf = BOOST_COUNTER_BASED_ENGINE_BUFFER_BLOCKS*Nresult;
+    boost::uint64_t x = 1;
+    for(unsigned iter=0; iter<2000; ++iter){
+        boost::uint64_t r = boost::random::detail::selftest_word<boost::uint64_t>(x);
+        unsigned op = unsigned(r>>60)%6;
+        unsigned arg = unsigned(r>>32)%(3*Nbuf+2);
+        switch(op){
+        case 0:
+        case 1:
+            for(unsigned i=0; i<arg; ++i)
+                BOOST_CHECK_EQUAL(be(), ue());
+            break;
+        case 2:
+            be.discard(arg);
+            ue.discard(arg);
+            break;
+        case 3:{
+            std::vector<result_type> bv(arg), uv(arg);
+            be.fill(bv.begin(), bv.end());
+            ue.fill(uv.begin(), uv.end());
+            BOOST_CHECK_EQUAL_COLLECTIONS(bv.begin(), bv.end(), uv.begin(), uv.end());
+            break;
+        }
+        case 4:{
+            engine_t be2 = be;
+            BOOST_CHECK_EQUAL(be2, be);
+            be2();
+            BOOST_CHECK_NE(be2, be);
+            std::istringstream iss(to_string(ue));
+            iss >> be2;
+            BOOST_CHECK_EQUAL(be2, be);
+            // Self-assignment keeps the buffer.
+            const engine_t& self = be;
+            be = self;
+            BOOST_CHECK_EQUAL(be, be2);
+            BOOST_CHECK_EQUAL(be(), ue());
+            break;
+        }
+        case 5:
+            if( arg%4 == 0 ){
+                engine_t::domain_type base = {{arg}};
+                be.restart(base);
+                ue.restart(base);
+            }
+            break;
+        }
+        BOOST_CHECK_EQUAL(to_string(be), to_string(ue));
+    }
+}
+
+// Near the end of the counter space, the buffered engine must not
+// throw any sooner than the unbuffered one.
+BOOST_AUTO_TEST_CASE(test_buffered_end_of_sequence)
+{
+    const unsigned Nresult = engine_t::results_per_counter();
+    const boost::uintmax_t len = (boost::uintmax_t(1)<<BOOST_COUNTER_BASED_ENGINE_CTRBITS)*Nresult;
+    engine_t be;
+    unbuffered_engine_t ue;
+    be.discard(len-3);
+    ue.discard(len-3);
+    for(int i=0; i<3; ++i)
+        BOOST_CHECK_EQUAL(be(), ue());
+    BOOST_CHECK_EQUAL(to_string(be), to_string(ue));
+    BOOST_CHECK_THROW(ue(), std::invalid_argument);
+    BOOST_CHECK_THROW(be(), std::invalid_argument);
+}
@@ -0,0 +1,102 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#include <boost/random/compact_counter_based_engine.hpp>
+#include <boost/random/counter_based_engine.hpp>
+#include <boost/random/philox.hpp>
+#include <boost/random/threefry.hpp>
+#include <boost/cstdint.hpp>
+#include <sstream>
+#include <vector>
+
+using boost::random::compact_counter_based_engine;
+using boost::random::counter_based_engine;
+using boost::random::philox;
+using boost::random::threefry;
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+// A compact engine over make_prf(k) is indistinguishable from
+// counter_based_engine(k, base), except for its size.
+template <typename Uint, typename Prf>
+void docompact(){
+    typedef counter_based_engine<Uint, Prf> eng_t;
+    typedef compact_counter_based_engine<Uint, Prf> ceng_t;
+    typedef typename eng_t::result_type result_type;
+    typedef typename eng_t::key_type key_type;
+    typedef typename eng_t::domain_type domain_type;
+    BOOST_CHECK_LT(sizeof(ceng_t), sizeof(eng_t));
+
+    const unsigned Nresult = eng_t::results_per_counter();
+    const unsigned n = 9*Nresult + 2;
+    key_type k = eng_t::key_traits::make_counter(987654321u);
+    const Prf prf = ceng_t::make_prf(k);
+    for(unsigned i=0; i<3; ++i){
+        domain_type base = eng_t::domain_traits::make_counter(31u*i);
+        eng_t eng(k, base);
+        ceng_t ceng(prf, base);
+        std::vector<result_type> expected(n), actual(n);
+        for(unsigned j=0; j<n; ++j){
+            if( j == 1 ){
+                BOOST_CHECK(ceng == ceng_t(ceng));
+            }
+            expected[j] = eng();
+            actual[j] = ceng();
+        }
+        BOOST_CHECK(actual == expected);
+        for(unsigned j=0; j<n; ++j)
+            BOOST_CHECK_EQUAL(ceng[j], expected[j]);
+
+        // fill and discard, from every position in a block.
+        for(unsigned j=0; j<=Nresult; ++j){
+            ceng_t ceng2(prf, base);
+            ceng2.discard(j);
+            std::vector<result_type> filled(n-j);
+            ceng2.fill(filled.begin(), filled.end());
+            BOOST_CHECK(std::equal(filled.begin(), filled.end(), expected.begin()+j));
+            BOOST_CHECK(ceng2 == ceng);
+        }
+
+        // Streams in both directions.
+        std::ostringstream os, cos;
+        os << eng;
+        cos << ceng;
+        BOOST_CHECK_EQUAL(os.str(), cos.str());
+        ceng_t ceng3(prf);
+        std::istringstream is(os.str());
+        is >> ceng3;
+        BOOST_CHECK(is);
+        BOOST_CHECK(ceng3 == ceng);
+        BOOST_CHECK_EQUAL(ceng3(), eng());
+
+        // A different key doesn't match the shared Prf.
+        std::ostringstream os2;
+        os2 << eng_t(k, base);
+        const Prf other = ceng_t::make_prf(eng_t::key_traits::make_counter(3u));
+        ceng_t ceng4(other);
+        std::istringstream is2(os2.str());
+        is2 >> ceng4;
+        BOOST_CHECK(!is2);
+        BOOST_CHECK(ceng4 == ceng_t(other));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_compact)
+{
+    docompact<uint32_t, philox<4, uint32_t> >();
+    docompact<uint64_t, philox<2, uint64_t> >();
+    docompact<uint32_t, philox<2, uint64_t> >();
+    docompact<uint64_t, threefry<4, uint64_t> >();
+    docompact<uint32_t, threefry<2, uint32_t> >();
+}
+
+BOOST_AUTO_TEST_CASE(test_compact_size)
+{
+    // Just the pointer, the counter and the position.
+    typedef threefry<4, uint64_t> Prf;
+    BOOST_CHECK_LE(sizeof(compact_counter_based_engine<uint64_t, Prf>),
+                   sizeof(Prf*) + sizeof(Prf::domain_type) + sizeof(void*));
+}
@@ -6,9 +6,25 @@
 
 #include <boost/random/uniform_int_distribution.hpp>
 #include <boost/random/counter_based_engine.hpp>
+#include <boost/random/counter_based_iterator.hpp>
 #include <boost/limits.hpp>
+#include <vector>
+#include <sstream>
+#include <cstring>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+#include <boost/type_traits/has_trivial_assign.hpp>
+#include <boost/type_traits/has_trivial_destructor.hpp>
+#include <boost/type_traits/is_nothrow_move_constructible.hpp>
+#include <boost/type_traits/is_nothrow_move_assignable.hpp>
 
-typedef boost::random::counter_based_engine<BOOST_COUNTER_BASED_ENGINE_RESULT_TYPE, BOOST_PSEUDO_RANDOM_FUNCTION, BOOST_COUNTER_BASED_ENGINE_CTRBITS> engine_t;
+typedef boost::random::counter_based_engine<BOOST_COUNTER_BASED_ENGINE_RESULT_TYPE, BOOST_PSEUDO_RANDOM_FUNCTION, BOOST_COUNTER_BASED_ENGINE_CTRBITS> unbuffered_engine_t;
+#if defined(BOOST_COUNTER_BASED_ENGINE_BUFFER_BLOCKS)
+#include <boost/random/buffered_counter_based_engine.hpp>
+typedef boost::random::buffered_counter_based_engine<BOOST_COUNTER_BASED_ENGINE_RESULT_TYPE, BOOST_PSEUDO_RANDOM_FUNCTION, BOOST_COUNTER_BASED_ENGINE_BUFFER_BLOCKS, BOOST_COUNTER_BASED_ENGINE_CTRBITS> engine_t;
+#else
+typedef unbuffered_engine_t engine_t;
+#endif
 
 #define BOOST_RANDOM_URNG engine_t
 
@@ -67,5 +83,270 @@ BOOST_AUTO_TEST_CASE(test_huge_discard)
     do_test_huge_discard((std::numeric_limits<BOOST_RANDOM_URNG::result_type>::max)());
 }        
 
+// fill should produce exactly the same values as successive calls to
+// operator()(), and leave the engine in the same state, no matter
+// where in a block it starts or how many values it's asked for.
+BOOST_AUTO_TEST_CASE(test_fill)
+{
+    const unsigned Nresult = BOOST_RANDOM_URNG::results_per_counter();
+    for(unsigned skip=0; skip<=Nresult; ++skip){
+        for(unsigned n=0; n<=3*Nresult+1; ++n){
+            BOOST_RANDOM_URNG urng;
+            urng.discard(skip);
+            BOOST_RANDOM_URNG urng2 = urng;
+            std::vector<result_type> expected(n);
+            for(unsigned i=0; i<n; ++i)
+                expected[i] = urng();
+            std::vector<result_type> actual(n);
+            urng2.fill(actual.begin(), actual.end());
+            BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+            BOOST_CHECK_EQUAL(urng, urng2);
+            BOOST_CHECK_EQUAL(urng(), urng2());
+        }
+    }
+}
+
+// Long enough to go through fill's batches of blocks several times,
+// with a ragged end.
+BOOST_AUTO_TEST_CASE(test_fill_long)
+{
+    const unsigned Nresult = BOOST_RANDOM_URNG::results_per_counter();
+    const unsigned n = 101*Nresult + 3;
+    BOOST_RANDOM_URNG urng;
+    urng.discard(1);
+    BOOST_RANDOM_URNG urng2 = urng;
+    std::vector<result_type> expected(n);
+    for(unsigned i=0; i<n; ++i)
+        expected[i] = urng();
+    std::vector<result_type> actual(n);
+    urng2.fill(actual.begin(), actual.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(urng, urng2);
+    BOOST_CHECK_EQUAL(urng(), urng2());
+}
+
+// at(n) and operator[] should agree with operator()() from the
+// beginning of the sequence, no matter where the engine is, and
+// shouldn't change it.  That holds after a restart too.
+BOOST_AUTO_TEST_CASE(test_at)
+{
+    const unsigned Nresult = BOOST_RANDOM_URNG::results_per_counter();
+    const unsigned n = 7*Nresult + 3;
+    BOOST_RANDOM_URNG urng(12345);
+    std::vector<result_type> expected(n);
+    for(unsigned i=0; i<n; ++i)
+        expected[i] = urng();
+    BOOST_RANDOM_URNG urng2 = urng;
+    const BOOST_RANDOM_URNG& curng = urng;
+    for(unsigned i=0; i<n; ++i){
+        BOOST_CHECK_EQUAL(curng.at(i), expected[i]);
+        BOOST_CHECK_EQUAL(curng[i], expected[i]);
+    }
+    BOOST_CHECK_EQUAL(urng, urng2);
+    BOOST_CHECK_EQUAL(urng(), urng2());
+
+    BOOST_RANDOM_URNG::domain_type base = BOOST_RANDOM_URNG::domain_traits::make_counter(99u);
+    urng.restart(base);
+    urng2.restart(base);
+    urng2.discard(n);
+    for(unsigned i=0; i<n; ++i)
+        BOOST_CHECK_EQUAL(urng2[i], urng());
+
+    // A huge index is either past the end of the sequence, in which
+    // case at throws, or it's the same as discard + operator()().
+    boost::uintmax_t big = ((std::numeric_limits<boost::uintmax_t>::max)()>>1) + 5;
+    bool threw = false;
+    result_type bigval = 0;
+    try{
+        bigval = urng2.at(big);
+    }catch(std::invalid_argument&){
+        threw = true;
+    }
+    if(!threw){
+        urng2.restart(base);
+        urng2.discard(big);
+        BOOST_CHECK_EQUAL(urng2(), bigval);
+    }
+}
+
+// The values in a stream_range are those of the serial stream,
+// however the range is chopped up and in whatever order the pieces
+// are visited.
+BOOST_AUTO_TEST_CASE(test_stream_range)
+{
+    typedef boost::random::counter_based_iterator<BOOST_RANDOM_URNG> iter_t;
+    const unsigned Nresult = BOOST_RANDOM_URNG::results_per_counter();
+    const unsigned n = 23*Nresult + 5;
+    BOOST_RANDOM_URNG urng(777);
+    BOOST_RANDOM_URNG urng2 = urng;
+    std::vector<result_type> expected(n);
+    for(unsigned i=0; i<n; ++i)
+        expected[i] = urng2();
+
+    std::vector<result_type> actual(n);
+    std::copy(boost::begin(boost::random::stream_range(urng, n)),
+              boost::end(boost::random::stream_range(urng, n)), actual.begin());
+    BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+
+    // Chunks of assorted sizes, last chunk first.
+    std::vector<result_type> chunked(n);
+    iter_t first(urng, 0);
+    unsigned end = n;
+    unsigned len = 1;
+    while(end){
+        unsigned start = end > len ? end - len : 0;
+        std::copy(first + start, first + end, chunked.begin() + start);
+        end = start;
+        len = 2*len + 1;
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(chunked.begin(), chunked.end(), expected.begin(), expected.end());
+
+    // Iterator arithmetic.
+    iter_t last = boost::end(boost::random::stream_range(urng, 3, n));
+    BOOST_CHECK_EQUAL(last - first, (boost::intmax_t)n);
+    BOOST_CHECK_EQUAL(first[n-1], expected[n-1]);
+    BOOST_CHECK_EQUAL(*(last - 1), expected[n-1]);
+    BOOST_CHECK_EQUAL(*(2 + first), expected[2]);
+    iter_t it = first;
+    BOOST_CHECK_EQUAL(*it++, expected[0]);
+    BOOST_CHECK_EQUAL(*it, expected[1]);
+    BOOST_CHECK(first < it && it <= last && last > it && it >= first && it != first);
+    --it;
+    BOOST_CHECK(it == first);
+    BOOST_CHECK_EQUAL(boost::begin(boost::random::stream_range(urng, 3, n)).index(), 3u);
+
+    // The engine is unchanged.
+    for(unsigned i=0; i<n; ++i)
+        BOOST_CHECK_EQUAL(urng(), expected[i]);
+}
+
+// restart_and_draw<N> is restart followed by N calls to operator()(),
+// for N both less and more than one block's worth.
+template <unsigned N>
+void do_test_restart_and_draw(const BOOST_RANDOM_URNG& proto, BOOST_RANDOM_URNG::domain_type base){
+    BOOST_RANDOM_URNG urng = proto;
+    BOOST_RANDOM_URNG urng2 = proto;
+    result_type r[N+1];
+    r[N] = 12345;
+    result_type* p = urng.restart_and_draw<N>(base, r);
+    BOOST_CHECK(p == r+N);
+    BOOST_CHECK_EQUAL(r[N], 12345u);
+    urng2.restart(base);
+    for(unsigned i=0; i<N; ++i)
+        BOOST_CHECK_EQUAL(r[i], urng2());
+    BOOST_CHECK_EQUAL(urng, urng2);
+    BOOST_CHECK_EQUAL(urng(), urng2());
+
+    urng.restart_unchecked(base);
+    urng2.restart(base);
+    BOOST_CHECK_EQUAL(urng, urng2);
+    BOOST_CHECK_EQUAL(urng(), urng2());
+}
+
+BOOST_AUTO_TEST_CASE(test_restart_and_draw)
+{
+    BOOST_RANDOM_URNG urng(4321);
+    for(unsigned i=0; i<3; ++i){
+        BOOST_RANDOM_URNG::domain_type base = BOOST_RANDOM_URNG::domain_traits::make_counter(1000u*i);
+        do_test_restart_and_draw<0>(urng, base);
+        do_test_restart_and_draw<1>(urng, base);
+        do_test_restart_and_draw<2>(urng, base);
+        do_test_restart_and_draw<3>(urng, base);
+        do_test_restart_and_draw<5>(urng, base);
+        do_test_restart_and_draw<9>(urng, base);
+        do_test_restart_and_draw<17>(urng, base);
+        urng();
+    }
+}
+
+// A lazy engine is indistinguishable from an eager one, except for
+// when it calls the Prf.
+typedef boost::random::counter_based_engine<BOOST_COUNTER_BASED_ENGINE_RESULT_TYPE, BOOST_PSEUDO_RANDOM_FUNCTION, BOOST_COUNTER_BASED_ENGINE_CTRBITS,
+                                            unbuffered_engine_t::word_size, unbuffered_engine_t::domain_traits,
+                                            unbuffered_engine_t::range_traits, unbuffered_engine_t::key_traits, true> lazy_engine_t;
+
+BOOST_AUTO_TEST_CASE(test_lazy)
+{
+    const unsigned Nresult = unbuffered_engine_t::results_per_counter();
+    const unsigned n = 5*Nresult + 1;
+    unbuffered_engine_t eager(2468);
+    lazy_engine_t lazy(2468);
+    BOOST_CHECK(lazy_engine_t::lazy);
+    BOOST_CHECK_EQUAL(lazy, lazy_engine_t(2468));
+    BOOST_CHECK(lazy != lazy_engine_t(2469));
+
+    std::vector<result_type> ev(n), lv(n);
+    for(unsigned i=0; i<3; ++i){
+        unbuffered_engine_t::domain_type base = unbuffered_engine_t::domain_traits::make_counter(7u*i);
+        eager.restart(base);
+        lazy.restart(base);
+        // Copies and stream round trips, before and after the Prf
+        // has been called.
+        std::ostringstream eos, los;
+        eos << eager;
+        los << lazy;
+        BOOST_CHECK_EQUAL(eos.str(), los.str());
+        lazy_engine_t lazy2 = lazy;
+        lazy_engine_t lazy3;
+        std::istringstream eis(eos.str());
+        eis >> lazy3;
+        BOOST_CHECK_EQUAL(lazy2, lazy);
+        BOOST_CHECK_EQUAL(lazy3, lazy);
+        // restart_and_draw<0> is a restart, lazy or not.
+        lazy_engine_t lazy4(2468);
+        BOOST_CHECK(lazy4.restart_and_draw<0>(base, &lv[0]) == &lv[0]);
+        BOOST_CHECK_EQUAL(lazy4, lazy);
+        std::ostringstream los4;
+        los4 << lazy4;
+        BOOST_CHECK_EQUAL(los4.str(), los.str());
+        for(unsigned j=0; j<n; ++j){
+            ev[j] = eager();
+            lv[j] = lazy();
+        }
+        BOOST_CHECK_EQUAL_COLLECTIONS(lv.begin(), lv.end(), ev.begin(), ev.end());
+        lazy2.fill(lv.begin(), lv.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(lv.begin(), lv.end(), ev.begin(), ev.end());
+        lazy3.discard(i);
+        BOOST_CHECK_EQUAL(lazy3(), ev[i]);
+        lazy3.discard(n-i-1);
+        BOOST_CHECK_EQUAL(lazy3, lazy);
+        BOOST_CHECK_EQUAL(lazy2, lazy);
+        BOOST_CHECK_EQUAL(lazy(), eager());
+
+        std::ostringstream eos2, los2;
+        eos2 << eager;
+        los2 << lazy;
+        BOOST_CHECK_EQUAL(eos2.str(), los2.str());
+        std::istringstream lis(los2.str());
+        lis >> eager;
+        BOOST_CHECK_EQUAL(eager(), lazy());
+    }
+}
+
+// Engines are trivially copyable, so a memcpy'ed engine is as good as
+// a copy-constructed one.
+BOOST_STATIC_ASSERT(boost::has_trivial_copy<unbuffered_engine_t>::value);
+BOOST_STATIC_ASSERT(boost::has_trivial_destructor<unbuffered_engine_t>::value);
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+// (boost::has_trivial_assign is only reliable in C++11.)
+BOOST_STATIC_ASSERT(boost::has_trivial_assign<unbuffered_engine_t>::value);
+BOOST_STATIC_ASSERT(boost::is_nothrow_move_constructible<unbuffered_engine_t>::value);
+BOOST_STATIC_ASSERT(boost::is_nothrow_move_assignable<unbuffered_engine_t>::value);
+#endif
+#if !defined(BOOST_NO_CXX11_CONSTEXPR)
+BOOST_STATIC_ASSERT(unbuffered_engine_t::results_per_counter() > 0);
+#endif
+
+BOOST_AUTO_TEST_CASE(test_memcpy)
+{
+    unbuffered_engine_t urng(1357);
+    urng.discard(3);
+    unbuffered_engine_t urng2;
+    std::memcpy(static_cast<void*>(&urng2), static_cast<const void*>(&urng), sizeof(urng));
+    BOOST_CHECK_EQUAL(urng, urng2);
+    for(unsigned i=0; i<3*unbuffered_engine_t::results_per_counter(); ++i)
+        BOOST_CHECK_EQUAL(urng(), urng2());
+}
+
 // TODO: restart, seed(key), constructor(Prf, start), limited counter width.
 
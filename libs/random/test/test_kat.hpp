@@ -5,15 +5,22 @@
 // http://www.boost.org/LICENSE_1_0.txt )
 
 #include "concepts.hpp"
+#include <boost/random/detail/prf_batch.hpp>
+#include <boost/random/detail/simd_dispatch.hpp>
 #include <boost/cstdint.hpp>
 #include <string>
 #include <sstream>
+#include <vector>
 #include "rangeIO.hpp"
 #include "printlogarray.hpp"
 
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 
+// dokat - check a known answer, both with the one-at-a-time
+// operator()(ctr) and with detail::prf_batch, with the known answer in
+// every position of a batch long enough to engage any multi-lane
+// kernels.
 template <typename Prf>
 void dokat(const std::string& s){
     std::istringstream iss(s);
@@ -28,5 +35,84 @@ void dokat(const std::string& s){
     BOOST_CHECK_EQUAL(computed, answer);
     Prf prf(key);
     BOOST_CHECK_EQUAL(prf(ctr), answer);
+
+    static const std::size_t N = 19;
+    std::vector<typename Prf::domain_type> in(N, ctr);
+    std::vector<typename Prf::range_type> out(N);
+    const Prf& cprf = prf;
+    boost::random::detail::prf_batch(cprf, &in[0], &out[0], N);
+    for(std::size_t i=0; i<N; ++i)
+        BOOST_CHECK_EQUAL(out[i], answer);
+}
+
+// dobatch - check that detail::prf_batch(prf, in, out, n) agrees with
+// the scalar operator()(ctr) for lots of different n, including n's
+// that aren't multiples of any plausible SIMD width.  The keys and
+// counters come from detail::selftest_words, the 64-bit LCG that the
+// SIMD kernels' self-tests use.
+template <typename Prf>
+void dobatch(){
+    typedef typename Prf::domain_type domain_type;
+    typedef typename Prf::range_type range_type;
+    typedef typename Prf::key_type key_type;
+    boost::uint64_t x = 0x243f6a8885a308d3ull;
+    key_type key;
+    boost::random::detail::selftest_words(key, x);
+    Prf prf(key);
+    for(std::size_t n=0; n<=40; ++n){
+        std::vector<domain_type> in(n);
+        for(std::size_t i=0; i<n; ++i)
+            boost::random::detail::selftest_words(in[i], x);
+        std::vector<range_type> out(n+1);
+        range_type sentinel = prf(domain_type());
+        out[n] = sentinel;
+        boost::random::detail::prf_batch(prf, in.empty() ? 0 : &in[0], &out[0], n);
+        for(std::size_t i=0; i<n; ++i)
+            BOOST_CHECK_EQUAL(out[i], prf(in[i]));
+        // Don't scribble past the end.
+        BOOST_CHECK_EQUAL(out[n], sentinel);
+    }
 }
 
+// docached - check that a Prf with a cached key schedule agrees with
+// the plain one, for lots of keys and counters, after construction,
+// setkey (directly and through a reference to its base), copying and
+// assignment.
+template <typename Plain, typename Cached>
+void docached(){
+    typedef typename Plain::domain_type domain_type;
+    typedef typename Plain::key_type key_type;
+    boost::uint64_t x = 0x13198a2e03707344ull;
+    Cached cached0;
+    Cached cached4;
+    BOOST_CHECK_EQUAL(cached0(domain_type()), Plain()(domain_type()));
+    for(int iter=0; iter<20; ++iter){
+        key_type key;
+        boost::random::detail::selftest_words(key, x);
+        Plain plain(key);
+        Cached cached(key);
+        Cached cached2;
+        cached2.setkey(key);
+        Cached cached3(cached);
+        cached0 = cached;
+        typename Cached::base_type& base4 = cached4;
+        base4.setkey(key);
+        BOOST_CHECK(cached.getkey() == key);
+        BOOST_CHECK(cached2 == cached);
+        BOOST_CHECK(cached4 == cached);
+        for(int i=0; i<10; ++i){
+            domain_type ctr;
+            boost::random::detail::selftest_words(ctr, x);
+            typename Plain::range_type answer = plain(ctr);
+            BOOST_CHECK_EQUAL(cached(ctr), answer);
+            BOOST_CHECK_EQUAL(cached2(ctr), answer);
+            BOOST_CHECK_EQUAL(cached3(ctr), answer);
+            BOOST_CHECK_EQUAL(cached0(ctr), answer);
+            BOOST_CHECK_EQUAL(cached4(ctr), answer);
+            typename Plain::range_type batched;
+            boost::random::detail::prf_batch(cached4, &ctr, &batched, 1);
+            BOOST_CHECK_EQUAL(batched, answer);
+        }
+    }
+    dobatch<Cached>();
+}
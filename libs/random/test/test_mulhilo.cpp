@@ -5,6 +5,8 @@
 // http://www.boost.org/LICENSE_1_0.txt )
 
 #include <boost/random/detail/mulhilo.hpp>
+#include <boost/random/detail/mulhilo_v.hpp>
+#include <boost/array.hpp>
 #include <cassert>
 #include <iostream>
 #include <typeinfo>
@@ -15,6 +17,7 @@ using boost::random::uniform_int_distribution;
 using boost::random::mt11213b;
 using boost::random::detail::mulhilo;
 using boost::random::detail::mulhilo_halfword;
+using boost::random::detail::mulhilo_v;
 
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
@@ -41,6 +44,42 @@ void doit(){
     }
 }
 
+// Every 64-bit policy that's available must agree with
+// mulhilo_halfword, including at the extremes.
+template <typename Policy>
+void dopolicy(){
+    uniform_int_distribution<uint64_t> D;
+    mt11213b mt;
+    const uint64_t special[] = {0, 1, 2, UINT64_C(0xffffffff), UINT64_C(0x100000000),
+                                UINT64_C(0x8000000000000000), ~UINT64_C(0), ~UINT64_C(1)};
+    const unsigned Nspecial = sizeof(special)/sizeof(*special);
+    for(int i=0; i<1000000; ++i){
+        uint64_t a = i<int(Nspecial*Nspecial) ? special[i%Nspecial] : D(mt);
+        uint64_t b = i<int(Nspecial*Nspecial) ? special[i/Nspecial] : D(mt);
+        uint64_t hi, lo, hi_hw, lo_hw;
+        lo = Policy::apply(a, b, hi);
+        lo_hw = mulhilo_halfword(a, b, hi_hw);
+        BOOST_CHECK_EQUAL(lo, lo_hw);
+        BOOST_CHECK_EQUAL(hi, hi_hw);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_mulhilo64_policies)
+{
+    using namespace boost::random::detail;
+    dopolicy<mulhilo_halfword_policy>();
+    dopolicy<mulhilo64_policy>();
+#if defined(BOOST_RANDOM_HAVE_MULHILO_INT128)
+    dopolicy<mulhilo_int128_policy>();
+#endif
+#if defined(BOOST_RANDOM_HAVE_MULHILO_MULQ)
+    dopolicy<mulhilo_mulq_policy>();
+#endif
+#if defined(BOOST_RANDOM_HAVE_MULHILO_MULX)
+    dopolicy<mulhilo_mulx_policy>();
+#endif
+}
+
 BOOST_AUTO_TEST_CASE(test_mulhilo)
 {
     doit<uint8_t>();
@@ -48,3 +87,113 @@ BOOST_AUTO_TEST_CASE(test_mulhilo)
     doit<uint32_t>();
     doit<uint64_t>();
 }
+
+// vcall<Uint, Bytes>::apply - mulhilo_v<Uint> on Bytes/sizeof(Uint)
+// lanes, through the SIMD register type that's Bytes wide.  They're
+// compiled for the instruction sets in simd.hpp, like the kernels that
+// use mulhilo_v, so the test only calls them if the CPU has them.
+template <typename Uint, unsigned Bytes>
+struct vcall;
+
+#if defined(BOOST_RANDOM_HAVE_SSE41)
+template <typename Uint>
+struct vcall<Uint, 16>{
+    BOOST_RANDOM_DETAIL_SSE41_TARGET
+    static void apply(const Uint* a, const Uint* b, Uint* hi, Uint* lo){
+        __m128i vhi;
+        __m128i vlo = mulhilo_v<Uint>(_mm_loadu_si128((const __m128i*)a), _mm_loadu_si128((const __m128i*)b), vhi);
+        _mm_storeu_si128((__m128i*)hi, vhi);
+        _mm_storeu_si128((__m128i*)lo, vlo);
+    }
+};
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+template <typename Uint>
+struct vcall<Uint, 32>{
+    BOOST_RANDOM_DETAIL_AVX2_TARGET
+    static void apply(const Uint* a, const Uint* b, Uint* hi, Uint* lo){
+        __m256i vhi;
+        __m256i vlo = mulhilo_v<Uint>(_mm256_loadu_si256((const __m256i*)a), _mm256_loadu_si256((const __m256i*)b), vhi);
+        _mm256_storeu_si256((__m256i*)hi, vhi);
+        _mm256_storeu_si256((__m256i*)lo, vlo);
+    }
+};
+#endif
+
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_PUSH
+template <typename Uint>
+struct vcall<Uint, 64>{
+    BOOST_RANDOM_DETAIL_AVX512_TARGET
+    static void apply(const Uint* a, const Uint* b, Uint* hi, Uint* lo){
+        __m512i vhi;
+        __m512i vlo = mulhilo_v<Uint>(_mm512_loadu_si512(a), _mm512_loadu_si512(b), vhi);
+        _mm512_storeu_si512(hi, vhi);
+        _mm512_storeu_si512(lo, vlo);
+    }
+};
+BOOST_RANDOM_DETAIL_AVX512_WARNINGS_POP
+#endif
+
+// Every lane of mulhilo_v must agree with the scalar reference,
+// mulhilo_v on a boost::array, which must agree with
+// mulhilo_halfword.  First, every pair of special values in every
+// lane, then random values.
+template <typename UINT, unsigned Bytes>
+void dovector(){
+    const unsigned L = Bytes/sizeof(UINT);
+    typedef boost::array<UINT, L> vec_t;
+    const UINT special[] = {0, 1, 2, 3, UINT(~UINT(0)>>1), UINT((~UINT(0)>>1)+1), UINT(~UINT(0)-1), UINT(~UINT(0)),
+                            UINT(UINT(~UINT(0))>>(std::numeric_limits<UINT>::digits/2)),
+                            UINT(UINT(1)<<(std::numeric_limits<UINT>::digits/2))};
+    const unsigned Nspecial = sizeof(special)/sizeof(*special);
+    uniform_int_distribution<UINT> D;
+    mt11213b mt;
+    for(unsigned i=0; i<Nspecial*Nspecial + 100000; ++i){
+        vec_t a, b, hi, lo, refhi, reflo;
+        for(unsigned j=0; j<L; ++j){
+            if( i < Nspecial*Nspecial ){
+                unsigned s = i + j;
+                a[j] = special[s%Nspecial];
+                b[j] = special[(s/Nspecial)%Nspecial];
+            }else{
+                a[j] = D(mt);
+                b[j] = D(mt);
+            }
+        }
+        reflo = mulhilo_v(a, b, refhi);
+        vcall<UINT, Bytes>::apply(a.data(), b.data(), hi.data(), lo.data());
+        for(unsigned j=0; j<L; ++j){
+            UINT hi_hw;
+            UINT lo_hw = mulhilo_halfword(a[j], b[j], hi_hw);
+            BOOST_CHECK_EQUAL(reflo[j], lo_hw);
+            BOOST_CHECK_EQUAL(refhi[j], hi_hw);
+            BOOST_CHECK_EQUAL(lo[j], lo_hw);
+            BOOST_CHECK_EQUAL(hi[j], hi_hw);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_mulhilo_v)
+{
+    using namespace boost::random::detail;
+#if defined(BOOST_RANDOM_HAVE_SSE41)
+    if( cpu_simd_level() >= simd_sse41 ){
+        dovector<uint32_t, 16>();
+        dovector<uint64_t, 16>();
+    }
+#endif
+#if defined(BOOST_RANDOM_HAVE_AVX2)
+    if( cpu_simd_level() >= simd_avx2 ){
+        dovector<uint32_t, 32>();
+        dovector<uint64_t, 32>();
+    }
+#endif
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+    if( cpu_simd_level() >= simd_avx512 ){
+        dovector<uint32_t, 64>();
+        dovector<uint64_t, 64>();
+    }
+#endif
+}
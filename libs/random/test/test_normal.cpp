@@ -0,0 +1,141 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#include <boost/random/fill_normal.hpp>
+#include <boost/random/counter_based_engine.hpp>
+#include <boost/random/philox.hpp>
+#include <boost/random/threefry.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/limits.hpp>
+#include <cmath>
+#include <vector>
+
+using boost::random::counter_based_engine;
+using boost::random::philox;
+using boost::random::threefry;
+using boost::random::fill_normal;
+using boost::random::u01_open_closed;
+using boost::random::u01_closed_open;
+using boost::random::detail::box_muller_math;
+using boost::random::detail::uniform01_converter;
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+typedef counter_based_engine<uint32_t, philox<4, uint32_t> > eng32;
+typedef counter_based_engine<uint64_t, threefry<4, uint64_t> > eng64;
+
+// The polynomial log and sincos against libm, in long double.
+template <typename Real>
+void domath(Real tol){
+    typedef box_muller_math<Real> math;
+    const int p = std::numeric_limits<Real>::digits;
+    Real worst_log = 0, worst_trig = 0;
+    for(int i=0; i<=100000; ++i){
+        Real u = Real(i)/100000;
+        if(u > 0){
+            long double l = std::log((long double)u);
+            worst_log = (std::max)(worst_log, Real(std::fabs(math::log(u) - l)/(std::max)(1.L, std::fabs(l))));
+        }
+        Real s, c;
+        math::sincos2pi(u, &s, &c);
+        long double a = 2*3.14159265358979323846264338327950288L*u;
+        worst_trig = (std::max)(worst_trig, Real(std::fabs(s - std::sin(a))));
+        worst_trig = (std::max)(worst_trig, Real(std::fabs(c - std::cos(a))));
+    }
+    BOOST_CHECK_EQUAL(math::log(Real(1)), Real(0));
+    BOOST_CHECK_CLOSE_FRACTION(math::log(std::ldexp(Real(1), -p)), -p*std::log(2.L), tol);
+    BOOST_CHECK_SMALL(worst_log, tol);
+    BOOST_CHECK_SMALL(worst_trig, tol);
+}
+
+BOOST_AUTO_TEST_CASE(test_box_muller_math)
+{
+    domath<float>(4*std::numeric_limits<float>::epsilon());
+    domath<double>(4*std::numeric_limits<double>::epsilon());
+}
+
+// fill_normal's values against Box-Muller in long double, using the
+// same uniforms, and the engine left where it should be.
+template <typename Real, typename Engine>
+void doaccuracy(Real tol){
+    typedef typename Engine::result_type Uint;
+    const uniform01_converter<Real, Uint, Engine::word_size, u01_open_closed> conv1;
+    const uniform01_converter<Real, Uint, Engine::word_size, u01_closed_open> conv2;
+    const unsigned n = 20001;
+    Engine e(11), e2(11);
+    std::vector<Real> z(n);
+    fill_normal(e, &z[0], n);
+    for(unsigned i=0; i<n; i+=2){
+        long double r = std::sqrt(-2*std::log((long double)conv1(e2())));
+        long double a = 2*3.14159265358979323846264338327950288L*conv2(e2());
+        BOOST_CHECK_SMALL(Real(z[i] - r*std::cos(a)), tol*Real((std::max)(1.L, r)));
+        if(i+1<n)
+            BOOST_CHECK_SMALL(Real(z[i+1] - r*std::sin(a)), tol*Real((std::max)(1.L, r)));
+    }
+    BOOST_CHECK(e == e2);
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_normal_accuracy)
+{
+    doaccuracy<float, eng32>(8*std::numeric_limits<float>::epsilon());
+    doaccuracy<double, eng64>(8*std::numeric_limits<double>::epsilon());
+    doaccuracy<double, eng32>(8*std::numeric_limits<double>::epsilon());
+}
+
+// The values don't depend on how the range is split into calls, and
+// mean and sigma just scale and shift them.
+template <typename Real, typename Engine>
+void dochunks(){
+    const unsigned n = 1001;
+    Engine e(5), e2(5), e3(5);
+    std::vector<Real> all(n), chunked(n), scaled(n);
+    fill_normal(e, &all[0], n);
+    const unsigned sizes[] = {2, 34, 0, 64, 100, 512, 288};
+    unsigned done = 0;
+    for(unsigned j=0; j<sizeof(sizes)/sizeof(*sizes); ++j){
+        fill_normal(e2, &chunked[done], sizes[j]);
+        done += sizes[j];
+    }
+    fill_normal(e2, &chunked[done], n-done);
+    BOOST_CHECK(all == chunked);
+    BOOST_CHECK(e == e2);
+
+    fill_normal(e3, &scaled[0], n, Real(3), Real(2));
+    for(unsigned i=0; i<n; ++i)
+        BOOST_CHECK_CLOSE_FRACTION(scaled[i], Real(3) + Real(2)*all[i], 4*std::numeric_limits<Real>::epsilon());
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_normal_chunks)
+{
+    dochunks<float, eng32>();
+    dochunks<double, eng64>();
+}
+
+// Crude moments.
+template <typename Real, typename Engine>
+void domoments(){
+    const unsigned n = 1000000;
+    Engine e;
+    std::vector<Real> z(n);
+    fill_normal(e, &z[0], n);
+    double m1 = 0, m2 = 0, m4 = 0;
+    for(unsigned i=0; i<n; ++i){
+        double x = z[i];
+        m1 += x;
+        m2 += x*x;
+        m4 += x*x*x*x;
+    }
+    m1 /= n; m2 /= n; m4 /= n;
+    BOOST_CHECK_SMALL(m1, 5/std::sqrt(double(n)));
+    BOOST_CHECK_SMALL(m2 - 1, 5*std::sqrt(2./n));
+    BOOST_CHECK_SMALL(m4 - 3, 5*std::sqrt(96./n));
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_normal_moments)
+{
+    domoments<float, eng32>();
+    domoments<double, eng64>();
+}
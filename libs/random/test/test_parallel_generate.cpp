@@ -0,0 +1,100 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#include <boost/random/parallel_generate.hpp>
+#include <boost/random/counter_based_engine.hpp>
+#include <boost/random/buffered_counter_based_engine.hpp>
+#include <boost/random/philox.hpp>
+#include <boost/random/threefry.hpp>
+#include <boost/cstdint.hpp>
+#include <stdexcept>
+#include <vector>
+
+using boost::random::counter_based_engine;
+using boost::random::buffered_counter_based_engine;
+using boost::random::parallel_generate;
+using boost::random::philox;
+using boost::random::threefry;
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+// parallel_generate must give exactly what fill gives, and leave the
+// engine in the same state, for any number of threads, whether or
+// not the engine starts at the beginning of a block.
+template <typename Engine>
+void doparallel(){
+    typedef typename Engine::result_type result_type;
+    const unsigned sizes[] = {0, 1, 4095, 4096*3+1, 100003};
+    const unsigned threads[] = {1, 2, 3, 4, 7, 16};
+    for(unsigned skip=0; skip<3; ++skip){
+        for(unsigned i=0; i<sizeof(sizes)/sizeof(*sizes); ++i){
+            const unsigned n = sizes[i];
+            Engine serial(12345);
+            serial.discard(skip);
+            Engine start(serial);
+            std::vector<result_type> expected(n);
+            serial.fill(expected.begin(), expected.end());
+            for(unsigned j=0; j<sizeof(threads)/sizeof(*threads); ++j){
+                Engine e(start);
+                std::vector<result_type> actual(n);
+                parallel_generate(e, actual.begin(), actual.end(), threads[j]);
+                BOOST_CHECK(actual == expected);
+                BOOST_CHECK(e == serial);
+                BOOST_CHECK_EQUAL(e(), Engine(serial)());
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_generate)
+{
+    doparallel<counter_based_engine<uint32_t, philox<4, uint32_t> > >();
+    doparallel<counter_based_engine<uint64_t, threefry<4, uint64_t> > >();
+    doparallel<counter_based_engine<uint32_t, threefry<2, uint64_t> > >();
+    doparallel<buffered_counter_based_engine<uint32_t, philox<2, uint32_t> > >();
+}
+
+// If there aren't enough values left in the sequence, it throws
+// before doing anything.
+BOOST_AUTO_TEST_CASE(test_parallel_generate_overflow)
+{
+    typedef counter_based_engine<uint32_t, philox<2, uint32_t>, 16> engine_t;
+    engine_t e;
+    engine_t e0(e);
+    const unsigned n = 2*65536 + 1;
+    std::vector<uint32_t> v(n, 7u);
+    BOOST_CHECK_THROW(parallel_generate(e, v.begin(), v.end(), 4), std::invalid_argument);
+    BOOST_CHECK(e == e0);
+    BOOST_CHECK(v == std::vector<uint32_t>(n, 7u));
+    // But it's fine to use up the whole sequence.
+    parallel_generate(e, v.begin(), v.end()-1, 4);
+    std::vector<uint32_t> expected(n-1);
+    e0.fill(expected.begin(), expected.end());
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), v.begin()));
+}
+
+// The same goes for ranges too short to be worth a thread, and for a
+// single thread, which are filled serially.
+BOOST_AUTO_TEST_CASE(test_parallel_generate_overflow_serial)
+{
+    typedef counter_based_engine<uint32_t, philox<4, uint32_t>, 8> engine_t;
+    const unsigned Nresult = engine_t::results_per_counter();
+    const unsigned threads[] = {0, 1, 4};
+    for(unsigned j=0; j<sizeof(threads)/sizeof(*threads); ++j){
+        engine_t e;
+        e.discard(256*Nresult - 10);
+        engine_t e0(e);
+        std::vector<uint32_t> v(20, 7u);
+        BOOST_CHECK_THROW(parallel_generate(e, v.begin(), v.end(), threads[j]), std::invalid_argument);
+        BOOST_CHECK(e == e0);
+        BOOST_CHECK(v == std::vector<uint32_t>(20, 7u));
+        parallel_generate(e, v.begin(), v.begin()+10, threads[j]);
+        std::vector<uint32_t> expected(10);
+        e0.fill(expected.begin(), expected.end());
+        BOOST_CHECK(std::equal(expected.begin(), expected.end(), v.begin()));
+        BOOST_CHECK(e == e0);
+    }
+}
@@ -5,11 +5,13 @@
 // http://www.boost.org/LICENSE_1_0.txt )
 
 #include <boost/random/philox.hpp>
+#include <boost/static_assert.hpp>
 #include <boost/cstdint.hpp>
 
 #include "test_kat.hpp"
 
 using boost::random::philox;
+using boost::random::philox_constants;
 
 using boost::random::test::RandomNumberFunctor;
 BOOST_CONCEPT_ASSERT((RandomNumberFunctor< boost::random::philox<2, uint32_t> >));
@@ -17,6 +19,13 @@ BOOST_CONCEPT_ASSERT((RandomNumberFunctor< boost::random::philox<2, uint64_t> >)
 BOOST_CONCEPT_ASSERT((RandomNumberFunctor< boost::random::philox<4, uint32_t> >));
 BOOST_CONCEPT_ASSERT((RandomNumberFunctor< boost::random::philox<4, uint64_t> >));
 
+// The batch operator()s are found by has_batch_operator, so
+// counter_based_engine::fill will use them.
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator< boost::random::philox<2, uint32_t> >::value);
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator< boost::random::philox<2, uint64_t> >::value);
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator< boost::random::philox<4, uint32_t> >::value);
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator< boost::random::philox<4, uint64_t> >::value);
+
 // The KAT vectors are cut-and-pasted from the kat_vectors file
 // in the original Random123 distribution.  The generators that
 // produce these known answers have been extensively tested and are
@@ -62,3 +71,23 @@ BOOST_AUTO_TEST_CASE(test_kat_philox4x64)
     dokat<philox<4, uint64_t, 10> >(" 243f6a8885a308d3 13198a2e03707344 a4093822299f31d0 082efa98ec4e6c89 452821e638d01377 be5466cf34e90c6c   a528f45403e61d95 38c72dbd566e9788 a5a1610e72fd18b5 57bd43b5e52b7fe6");
 }
 
+// Check the batch interface, which uses multi-lane SIMD kernels when
+// they're available.
+BOOST_AUTO_TEST_CASE(test_batch_philox)
+{
+    dobatch<philox<2, uint32_t> >();
+    dobatch<philox<2, uint64_t> >();
+    dobatch<philox<4, uint32_t> >();
+    dobatch<philox<4, uint32_t, 7> >();
+    dobatch<philox<4, uint64_t> >();
+}
+
+// The cached key schedule mode must compute exactly the same function.
+BOOST_AUTO_TEST_CASE(test_cached_philox)
+{
+    docached<philox<2, uint32_t>, philox<2, uint32_t, 10, philox_constants<2, uint32_t>, true> >();
+    docached<philox<2, uint64_t>, philox<2, uint64_t, 10, philox_constants<2, uint64_t>, true> >();
+    docached<philox<4, uint32_t>, philox<4, uint32_t, 10, philox_constants<4, uint32_t>, true> >();
+    docached<philox<4, uint64_t>, philox<4, uint64_t, 10, philox_constants<4, uint64_t>, true> >();
+    docached<philox<4, uint32_t, 7>, philox<4, uint32_t, 7, philox_constants<4, uint32_t>, true> >();
+}
@@ -5,8 +5,14 @@
 // http://www.boost.org/LICENSE_1_0.txt )
 
 #include <boost/random/sha1_prf.hpp>
+#include <boost/random/detail/prf_batch.hpp>
+#include <boost/static_assert.hpp>
 #include <boost/cstdint.hpp>
 
+// sha1_prf's batch operator() is found by has_batch_operator, so
+// counter_based_engine::fill will use it.
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator< boost::random::sha1_prf<4, 1> >::value);
+
 #define BOOST_COUNTER_BASED_ENGINE_RESULT_TYPE uint32_t
 #define BOOST_PSEUDO_RANDOM_FUNCTION boost::random::sha1_prf<4, 1>
 #define BOOST_COUNTER_BASED_ENGINE_CTRBITS 32
@@ -22,3 +28,124 @@
 
 #include "test_counter_based_engine.ipp"
 
+
+#include <boost/random/detail/sha1_block.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/uuid/sha1.hpp>
+#include <vector>
+
+// The FIPS 180-4 example:  SHA-1("abc") in a single block.
+BOOST_AUTO_TEST_CASE(test_sha1_compress_abc)
+{
+    const uint32_t abc[16] = {0x61626380, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 24};
+    const uint32_t expected[5] = {0xa9993e36, 0x4706816a, 0xba3e2571, 0x7850c26c, 0x9cd0d89d};
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    boost::random::detail::sha1_compress_portable(h, abc);
+    BOOST_CHECK_EQUAL_COLLECTIONS(h, h+5, expected, expected+5);
+#if defined(BOOST_RANDOM_HAVE_SHA1_SHANI)
+    if( boost::random::detail::sha1_has_shani() ){
+        uint32_t hni[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+        boost::random::detail::sha1_compress_shani(hni, abc);
+        BOOST_CHECK_EQUAL_COLLECTIONS(hni, hni+5, expected, expected+5);
+    }else{
+        BOOST_TEST_MESSAGE("no SHA extensions on this CPU - not testing sha1_compress_shani");
+    }
+#endif
+}
+
+// sha1_prf must give the same digests as streaming the message
+// through uuids::detail::sha1, whether or not it fits in one block.
+// Version 1's message is the byte Nkey, then the key and counter
+// words.  Version 2's is the key and counter words, then the byte
+// Nkey.
+template <unsigned Ndomain, unsigned Nkey, unsigned Version>
+void dosha1_vs_uuids(){
+    typedef boost::random::sha1_prf<Ndomain, Nkey, Version> prf_t;
+    boost::random::mt19937 mt;
+    for(unsigned i=0; i<1000; ++i){
+        typename prf_t::key_type k;
+        typename prf_t::domain_type c;
+        for(unsigned j=0; j<Nkey; ++j)
+            k[j] = mt();
+        for(unsigned j=0; j<Ndomain; ++j)
+            c[j] = mt();
+        boost::uuids::detail::sha1 h;
+        if( Version == 1 )
+            h.process_byte(Nkey);
+        for(unsigned j=0; j<Nkey+Ndomain; ++j){
+            uint32_t v = j<Nkey ? k[j] : c[j-Nkey];
+            for(int s=24; s>=0; s-=8)
+                h.process_byte((v>>s)&0xff);
+        }
+        if( Version == 2 )
+            h.process_byte(Nkey);
+        typename prf_t::range_type expected;
+        h.get_digest(expected.elems);
+        BOOST_CHECK(prf_t(k)(c) == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_sha1_single_block)
+{
+    dosha1_vs_uuids<1, 1, 1>();
+    dosha1_vs_uuids<4, 1, 1>();
+    dosha1_vs_uuids<4, 2, 1>();
+    dosha1_vs_uuids<10, 3, 1>();   // 53 bytes, the longest that fits
+    dosha1_vs_uuids<11, 3, 1>();   // 57 bytes, two blocks
+    dosha1_vs_uuids<16, 4, 1>();
+}
+
+BOOST_AUTO_TEST_CASE(test_sha1_version2)
+{
+    dosha1_vs_uuids<1, 1, 2>();
+    dosha1_vs_uuids<4, 1, 2>();
+    dosha1_vs_uuids<4, 2, 2>();
+    dosha1_vs_uuids<2, 8, 2>();
+    dosha1_vs_uuids<10, 3, 2>();
+    // setkey must refresh the cached midstate.
+    typedef boost::random::sha1_prf<4, 2, 2> prf_t;
+    prf_t::key_type k1 = {{1, 2}};
+    prf_t::key_type k2 = {{3, 4}};
+    prf_t::domain_type c = {{5, 6, 7, 8}};
+    prf_t p(k1);
+    p.setkey(k2);
+    BOOST_CHECK(p(c) == prf_t(k2)(c));
+    BOOST_CHECK(p(c) != prf_t(k1)(c));
+    // Version 2 is a different function.
+    BOOST_CHECK(p(c) != (boost::random::sha1_prf<4, 2>(k2)(c)));
+}
+
+// The batch operator() must agree with operator(), whatever the
+// number of counters and however they line up with the lanes of the
+// multi-buffer kernels.
+template <unsigned Ndomain, unsigned Nkey, unsigned Version>
+void dosha1_batch(){
+    typedef boost::random::sha1_prf<Ndomain, Nkey, Version> prf_t;
+    boost::random::mt19937 mt;
+    typename prf_t::key_type k;
+    for(unsigned j=0; j<Nkey; ++j)
+        k[j] = mt();
+    prf_t prf(k);
+    std::vector<typename prf_t::domain_type> in(71);
+    for(size_t i=0; i<in.size(); ++i)
+        for(unsigned j=0; j<Ndomain; ++j)
+            in[i][j] = mt();
+    for(size_t n=0; n<=in.size(); n+=(n<20 ? 1 : 17)){
+        std::vector<typename prf_t::range_type> out(n);
+        prf(n ? &in[0] : 0, n ? &out[0] : 0, n);
+        for(size_t i=0; i<n; ++i)
+            BOOST_CHECK(out[i] == prf(in[i]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_sha1_batch)
+{
+    dosha1_batch<1, 1, 1>();
+    dosha1_batch<4, 1, 1>();
+    dosha1_batch<4, 2, 1>();
+    dosha1_batch<10, 3, 1>();
+    dosha1_batch<11, 3, 1>();
+    dosha1_batch<4, 1, 2>();
+    dosha1_batch<4, 2, 2>();
+    dosha1_batch<2, 8, 2>();
+}
@@ -0,0 +1,203 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#include <boost/random/detail/cpu_features.hpp>
+#include <boost/random/detail/simd_dispatch.hpp>
+#include <boost/random/philox.hpp>
+#include <boost/random/threefry.hpp>
+#include <boost/random/sha1_prf.hpp>
+#include <boost/random/fill_uniform01.hpp>
+#include <boost/cstdint.hpp>
+#include <cstdlib>
+#include <vector>
+#include "printlogarray.hpp"
+
+using namespace boost::random::detail;
+using boost::random::philox;
+using boost::random::threefry;
+using boost::random::sha1_prf;
+using boost::random::u01_closed_open;
+using boost::random::u01_open_open;
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(test_parse_simd_level)
+{
+    simd_level l = simd_avx2;
+    BOOST_CHECK(parse_simd_level("scalar", l) && l == simd_scalar);
+    BOOST_CHECK(parse_simd_level("sse4.1", l) && l == simd_sse41);
+    BOOST_CHECK(parse_simd_level("avx2", l) && l == simd_avx2);
+    BOOST_CHECK(parse_simd_level("avx512", l) && l == simd_avx512);
+    BOOST_CHECK(!parse_simd_level(0, l));
+    BOOST_CHECK(!parse_simd_level("", l));
+    BOOST_CHECK(!parse_simd_level("AVX2", l));
+    BOOST_CHECK(!parse_simd_level("avx", l));
+    BOOST_CHECK_EQUAL(l, simd_avx512);
+}
+
+// Capping takes features away, and never adds them.
+BOOST_AUTO_TEST_CASE(test_cap_cpu_features)
+{
+    cpu_feature_flags all = {true, true, true, true, true, true, true};
+    BOOST_CHECK_EQUAL(simd_level_of(all), simd_avx512);
+    for(int l=simd_scalar; l<=simd_avx512; ++l)
+        BOOST_CHECK_EQUAL(simd_level_of(cap_cpu_features(all, simd_level(l))), l);
+    cpu_feature_flags s = cap_cpu_features(all, simd_scalar);
+    BOOST_CHECK(!s.sse41 && !s.aes && !s.sha && !s.avx2 && !s.avx512f && !s.avx512dq && !s.vaes);
+    cpu_feature_flags s41 = cap_cpu_features(all, simd_sse41);
+    BOOST_CHECK(s41.sse41 && s41.aes && s41.sha && !s41.avx2 && !s41.vaes);
+    cpu_feature_flags a2 = cap_cpu_features(all, simd_avx2);
+    BOOST_CHECK(a2.avx2 && !a2.avx512f && !a2.avx512dq && !a2.vaes);
+
+    // AVX-512F without DQ is only AVX2, as far as the kernels go.
+    cpu_feature_flags nodq = all;
+    nodq.avx512dq = false;
+    BOOST_CHECK_EQUAL(simd_level_of(nodq), simd_avx2);
+    BOOST_CHECK_EQUAL(simd_level_of(cap_cpu_features(nodq, simd_avx512)), simd_avx2);
+}
+
+// cpu_features() is what the CPU has, capped by BOOST_RANDOM_SIMD if
+// it's set.  (Run the tests with it set to each level to check the
+// selection at each one.)
+BOOST_AUTO_TEST_CASE(test_override)
+{
+    cpu_feature_flags f = probe_cpu_features();
+    simd_level l;
+    if( parse_simd_level(std::getenv("BOOST_RANDOM_SIMD"), l) ){
+        BOOST_TEST_MESSAGE("BOOST_RANDOM_SIMD=" << std::getenv("BOOST_RANDOM_SIMD"));
+        f = cap_cpu_features(f, l);
+        BOOST_CHECK(cpu_simd_level() <= l);
+    }
+    const cpu_feature_flags& g = cpu_features();
+    BOOST_CHECK_EQUAL(f.sse41, g.sse41);
+    BOOST_CHECK_EQUAL(f.aes, g.aes);
+    BOOST_CHECK_EQUAL(f.sha, g.sha);
+    BOOST_CHECK_EQUAL(f.avx2, g.avx2);
+    BOOST_CHECK_EQUAL(f.avx512f, g.avx512f);
+    BOOST_CHECK_EQUAL(f.avx512dq, g.avx512dq);
+    BOOST_CHECK_EQUAL(f.vaes, g.vaes);
+    BOOST_CHECK_EQUAL(cpu_simd_level(), simd_level_of(f));
+}
+
+// A family of kernels for select_kernel, where the kernel for level l
+// returns l, and the self-test fails the levels in 'broken'.
+std::size_t kernel_sse41(){ return simd_sse41; }
+std::size_t kernel_avx2(){ return simd_avx2; }
+std::size_t kernel_avx512(){ return simd_avx512; }
+
+struct fake_kernels{
+    typedef std::size_t (*kernel_type)();
+    static kernel_type kernel(simd_level l){
+        switch(l){
+        case simd_sse41: return &kernel_sse41;
+        case simd_avx2: return &kernel_avx2;
+        case simd_avx512: return &kernel_avx512;
+        default: return 0;
+        }
+    }
+};
+
+struct fake_test{
+    unsigned broken;
+    explicit fake_test(unsigned _broken) : broken(_broken){}
+    bool operator()(fake_kernels::kernel_type kernel) const{
+        return !((broken >> kernel()) & 1);
+    }
+};
+
+// select_kernel picks the highest level the CPU has whose kernel
+// passes the self-test, and nothing if none of them does.
+BOOST_AUTO_TEST_CASE(test_select_kernel)
+{
+    const int top = cpu_simd_level();
+    for(unsigned broken=0; broken<16; ++broken){
+        fake_kernels::kernel_type k = select_kernel<fake_kernels>(fake_test(broken));
+        int expect = top;
+        while( expect > simd_scalar && ((broken >> expect) & 1) )
+            --expect;
+        BOOST_CHECK_EQUAL(k ? int(k()) : int(simd_scalar), expect);
+    }
+}
+
+// The kernel for every level the CPU has, not just the one that's
+// selected, must agree with the Prf for any number of counters, and
+// mustn't write past the ones it does.
+template <typename Simd, typename Prf>
+void doprf_kernels(){
+    typedef typename Prf::domain_type domain_type;
+    typedef typename Prf::range_type range_type;
+    typedef typename Prf::key_type key_type;
+    uint64_t x = 0x243f6a8885a308d3ull;
+    key_type key;
+    selftest_words(key, x);
+    const Prf prf(key);
+    typename Simd::kernel_type best = 0;
+    for(int l=simd_sse41; l<=cpu_simd_level(); ++l){
+        typename Simd::kernel_type kernel = Simd::kernel(simd_level(l));
+        if( !kernel )
+            continue;
+        best = kernel;
+        BOOST_CHECK(prf_kernel_test<Prf>()(kernel));
+        for(std::size_t n=0; n<=40; ++n){
+            std::vector<domain_type> in(n+1);
+            for(std::size_t i=0; i<n; ++i)
+                selftest_words(in[i], x);
+            std::vector<range_type> out(n+1);
+            const range_type sentinel = prf(domain_type());
+            out[n] = sentinel;
+            std::size_t m = kernel(key, &in[0], &out[0], n);
+            BOOST_CHECK(m <= n && m+16 > n);
+            for(std::size_t i=0; i<m; ++i)
+                BOOST_CHECK_EQUAL(out[i], prf(in[i]));
+            BOOST_CHECK_EQUAL(out[m], m<n ? range_type() : sentinel);
+        }
+    }
+    BOOST_CHECK(Simd::selected() == best);
+}
+
+BOOST_AUTO_TEST_CASE(test_prf_kernels)
+{
+#if defined(BOOST_RANDOM_HAVE_SSE41) || defined(BOOST_RANDOM_HAVE_AVX2)
+    doprf_kernels<philox_simd<4, uint32_t, 10, boost::random::philox_constants<4, uint32_t> >, philox<4, uint32_t> >();
+    doprf_kernels<philox_simd<4, uint32_t, 7, boost::random::philox_constants<4, uint32_t> >, philox<4, uint32_t, 7> >();
+#endif
+#if defined(BOOST_RANDOM_HAVE_AVX512)
+    doprf_kernels<philox_simd<2, uint64_t, 10, boost::random::philox_constants<2, uint64_t> >, philox<2, uint64_t> >();
+    doprf_kernels<philox_simd<4, uint64_t, 10, boost::random::philox_constants<4, uint64_t> >, philox<4, uint64_t> >();
+#endif
+#if defined(BOOST_RANDOM_HAVE_AVX2) || defined(BOOST_RANDOM_HAVE_AVX512)
+    doprf_kernels<threefry_simd<2, uint64_t, 20, boost::random::threefry_constants<2, uint64_t> >, threefry<2, uint64_t> >();
+    doprf_kernels<threefry_simd<4, uint64_t, 20, boost::random::threefry_constants<4, uint64_t> >, threefry<4, uint64_t> >();
+    doprf_kernels<threefry_simd<4, uint64_t, 13, boost::random::threefry_constants<4, uint64_t> >, threefry<4, uint64_t, 13> >();
+#endif
+}
+
+// The other families' kernels, through their self-tests.
+template <typename Simd, typename Test>
+void doother_kernels(){
+    typename Simd::kernel_type best = 0;
+    for(int l=simd_sse41; l<=cpu_simd_level(); ++l){
+        typename Simd::kernel_type kernel = Simd::kernel(simd_level(l));
+        if( !kernel )
+            continue;
+        best = kernel;
+        BOOST_CHECK(Test()(kernel));
+    }
+    BOOST_CHECK(Simd::selected() == best);
+}
+
+BOOST_AUTO_TEST_CASE(test_other_kernels)
+{
+#if defined(BOOST_RANDOM_HAVE_AVX2) || defined(BOOST_RANDOM_HAVE_AVX512)
+    doother_kernels<sha1_simd<4, 2, 1, true>, sha1_kernel_test<4, 2, 1> >();
+    doother_kernels<sha1_simd<4, 2, 2, true>, sha1_kernel_test<4, 2, 2> >();
+    doother_kernels<sha1_simd<8, 5, 2, true>, sha1_kernel_test<8, 5, 2> >();
+    doother_kernels<uniform01_simd<float, uint32_t, 32, u01_closed_open>, uniform01_kernel_test<float, uint32_t, 32, u01_closed_open> >();
+    doother_kernels<uniform01_simd<float, uint32_t, 32, u01_open_open>, uniform01_kernel_test<float, uint32_t, 32, u01_open_open> >();
+    doother_kernels<uniform01_simd<double, uint64_t, 64, u01_closed_open>, uniform01_kernel_test<double, uint64_t, 64, u01_closed_open> >();
+    doother_kernels<uniform01_simd<double, uint64_t, 64, u01_open_open>, uniform01_kernel_test<double, uint64_t, 64, u01_open_open> >();
+#endif
+}
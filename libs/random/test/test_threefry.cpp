@@ -5,11 +5,13 @@
 // http://www.boost.org/LICENSE_1_0.txt )
 
 #include <boost/random/threefry.hpp>
+#include <boost/static_assert.hpp>
 #include <boost/cstdint.hpp>
 
 #include "test_kat.hpp"
 
 using boost::random::threefry;
+using boost::random::threefry_constants;
 
 using boost::random::test::RandomNumberFunctor;
 BOOST_CONCEPT_ASSERT((RandomNumberFunctor< boost::random::threefry<2, uint32_t> >));
@@ -17,6 +19,13 @@ BOOST_CONCEPT_ASSERT((RandomNumberFunctor< boost::random::threefry<2, uint64_t>
 BOOST_CONCEPT_ASSERT((RandomNumberFunctor< boost::random::threefry<4, uint32_t> >));
 BOOST_CONCEPT_ASSERT((RandomNumberFunctor< boost::random::threefry<4, uint64_t> >));
 
+// The batch operator()s are found by has_batch_operator, so
+// counter_based_engine::fill will use them.
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator< boost::random::threefry<2, uint32_t> >::value);
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator< boost::random::threefry<2, uint64_t> >::value);
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator< boost::random::threefry<4, uint32_t> >::value);
+BOOST_STATIC_ASSERT(boost::random::detail::has_batch_operator< boost::random::threefry<4, uint64_t> >::value);
+
 // The KAT vectors are cut-and-pasted from the kat_vectors file
 // in the original Random123 distribution.  The generators that
 // produce these known answers have been extensively tested and are
@@ -62,3 +71,25 @@ BOOST_AUTO_TEST_CASE(test_kat_threefry4x64)
     dokat<threefry<4, uint64_t, 20> > ("243f6a8885a308d3 13198a2e03707344 a4093822299f31d0 082efa98ec4e6c89 452821e638d01377 be5466cf34e90c6c be5466cf34e90c6c c0ac29b7c97c50dd   a7e8fde591651bd9 baafd0c30138319b 84a5c1a729e685b9 901d406ccebc1ba4");
 }
 
+// Check the batch interface, which uses multi-lane SIMD kernels when
+// they're available.
+BOOST_AUTO_TEST_CASE(test_batch_threefry)
+{
+    dobatch<threefry<2, uint32_t> >();
+    dobatch<threefry<2, uint64_t> >();
+    dobatch<threefry<2, uint64_t, 13> >();
+    dobatch<threefry<4, uint32_t> >();
+    dobatch<threefry<4, uint64_t> >();
+    dobatch<threefry<4, uint64_t, 12> >();
+}
+
+// The cached key schedule mode must compute exactly the same function.
+BOOST_AUTO_TEST_CASE(test_cached_threefry)
+{
+    docached<threefry<2, uint32_t>, threefry<2, uint32_t, 20, threefry_constants<2, uint32_t>, true> >();
+    docached<threefry<2, uint64_t>, threefry<2, uint64_t, 20, threefry_constants<2, uint64_t>, true> >();
+    docached<threefry<4, uint32_t>, threefry<4, uint32_t, 20, threefry_constants<4, uint32_t>, true> >();
+    docached<threefry<4, uint64_t>, threefry<4, uint64_t, 20, threefry_constants<4, uint64_t>, true> >();
+    docached<threefry<4, uint64_t, 12>, threefry<4, uint64_t, 12, threefry_constants<4, uint64_t>, true> >();
+    docached<threefry<2, uint64_t, 13>, threefry<2, uint64_t, 13, threefry_constants<2, uint64_t>, true> >();
+}
@@ -0,0 +1,137 @@
+// Copyright 2010-2014, D. E. Shaw Research.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt )
+
+#include <boost/random/fill_uniform01.hpp>
+#include <boost/random/counter_based_engine.hpp>
+#include <boost/random/philox.hpp>
+#include <boost/random/threefry.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/limits.hpp>
+#include <cmath>
+#include <vector>
+
+using boost::random::counter_based_engine;
+using boost::random::philox;
+using boost::random::threefry;
+using boost::random::fill_uniform01;
+using boost::random::uniform01_interval;
+using boost::random::u01_closed_open;
+using boost::random::u01_open_closed;
+using boost::random::u01_open_open;
+using boost::random::u01_closed_closed;
+using boost::random::detail::uniform01_converter;
+using boost::random::detail::uniform01_simd;
+
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+// The conversion, done the slow and obvious way, in long double.
+template <typename Real, unsigned w, uniform01_interval I>
+Real reference(boost::uintmax_t x){
+    int p = (std::min)(std::numeric_limits<Real>::digits - (I==u01_open_open), int(w));
+    long double k = static_cast<long double>(x >> (w - p));
+    switch(I){
+    case u01_closed_open: return static_cast<Real>(std::ldexp(k, -p));
+    case u01_open_closed: return static_cast<Real>(std::ldexp(k+1, -p));
+    case u01_open_open: return static_cast<Real>(std::ldexp(2*k+1, -p-1));
+    case u01_closed_closed: return static_cast<Real>(k/(std::ldexp(1.L, p)-1));
+    }
+    return 0;
+}
+
+// Check the converter, and the multi-lane kernel, against the
+// reference at both ends of the range, and in between.
+template <typename Real, typename Uint, uniform01_interval I>
+void doconvert(){
+    const unsigned w = std::numeric_limits<Uint>::digits;
+    typedef uniform01_converter<Real, Uint, w, I> conv_t;
+    const conv_t conv;
+    const Uint maxw = (std::numeric_limits<Uint>::max)();
+    const Real lo = conv(0);
+    const Real hi = conv(maxw);
+    BOOST_CHECK_EQUAL(lo, (reference<Real, w, I>(0)));
+    BOOST_CHECK_EQUAL(hi, (reference<Real, w, I>(maxw)));
+    BOOST_CHECK_EQUAL(lo == Real(0), I==u01_closed_open || I==u01_closed_closed);
+    BOOST_CHECK_EQUAL(hi == Real(1), I==u01_open_closed || I==u01_closed_closed);
+    BOOST_CHECK(lo >= 0 && hi <= 1);
+    if(I==u01_open_open || I==u01_closed_closed)
+        BOOST_CHECK_EQUAL(Real(1) - hi, lo);
+
+    std::vector<Uint> in(67);
+    Uint x = 0x9E3779B9u;
+    for(unsigned i=0; i<in.size(); ++i){
+        x = x*Uint(2862933555777941757ull) + Uint(3037000493u);
+        in[i] = (i%5==0) ? 0 : (i%5==1) ? maxw : x;
+    }
+    std::vector<Real> out(in.size());
+    std::size_t m = uniform01_simd<Real, Uint, w, I>::apply(conv, &in[0], &out[0], in.size());
+    BOOST_CHECK(m <= in.size());
+    for(std::size_t i=0; i<m; ++i)
+        BOOST_CHECK_EQUAL(out[i], conv(in[i]));
+    for(std::size_t i=0; i<in.size(); ++i)
+        BOOST_CHECK_EQUAL(conv(in[i]), (reference<Real, w, I>(in[i])));
+}
+
+template <typename Real, typename Uint>
+void doconvert_all(){
+    doconvert<Real, Uint, u01_closed_open>();
+    doconvert<Real, Uint, u01_open_closed>();
+    doconvert<Real, Uint, u01_open_open>();
+    doconvert<Real, Uint, u01_closed_closed>();
+}
+
+BOOST_AUTO_TEST_CASE(test_converter)
+{
+    doconvert_all<float, uint32_t>();
+    doconvert_all<double, uint64_t>();
+    doconvert_all<double, uint32_t>();
+    doconvert_all<float, uint64_t>();
+}
+
+// fill_uniform01 gives conv(eng()) for successive outputs of the
+// engine, however long the range, and leaves the engine where n
+// calls to eng() would.
+template <typename Real, uniform01_interval I, typename Engine>
+void dofill(){
+    typedef typename Engine::result_type Uint;
+    const uniform01_converter<Real, Uint, Engine::word_size, I> conv;
+    const unsigned sizes[] = {0, 1, 17, 512, 1031};
+    for(unsigned j=0; j<sizeof(sizes)/sizeof(*sizes); ++j){
+        const unsigned n = sizes[j];
+        Engine e(99);
+        e.discard(1);
+        Engine e2(e);
+        std::vector<Real> out(n+1);
+        fill_uniform01<Real, I>(e, &out[0], n);
+        for(unsigned i=0; i<n; ++i)
+            BOOST_CHECK_EQUAL(out[i], conv(e2()));
+        BOOST_CHECK(e == e2);
+    }
+}
+
+template <typename Real, typename Engine>
+void dofill_all(){
+    dofill<Real, u01_closed_open, Engine>();
+    dofill<Real, u01_open_closed, Engine>();
+    dofill<Real, u01_open_open, Engine>();
+    dofill<Real, u01_closed_closed, Engine>();
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_uniform01)
+{
+    typedef counter_based_engine<uint32_t, philox<4, uint32_t> > eng32;
+    typedef counter_based_engine<uint64_t, threefry<4, uint64_t> > eng64;
+    dofill_all<float, eng32>();
+    dofill_all<double, eng32>();
+    dofill_all<double, eng64>();
+    dofill_all<float, eng64>();
+
+    // The default interval is [0, 1).
+    eng64 e, e2;
+    std::vector<double> v(100), v2(100);
+    fill_uniform01(e, &v[0], v.size());
+    fill_uniform01<double, u01_closed_open>(e2, &v2[0], v2.size());
+    BOOST_CHECK(v == v2);
+}